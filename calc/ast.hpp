@@ -2,19 +2,41 @@
 #ifndef AST_HPP
 #define AST_HPP
 
+#include "cast.hpp"
+
+
+// The kinds of expressions.
+enum Expr_kind
+{
+  int_expr,
+  binary_expr,
+};
+
 
 struct Expr
 {
+  Expr(Expr_kind k)
+    : kind_(k)
+  { }
+
   virtual ~Expr() { }
+
+  static bool classof(Expr const*) { return true; }
+
+  Expr_kind kind() const { return kind_; }
+
+  Expr_kind kind_;
 };
 
 
 struct Int_expr : Expr
 {
   Int_expr(int n)
-    : val_(n)
+    : Expr(int_expr), val_(n)
   { }
 
+  static bool classof(Expr const* e) { return e->kind() == int_expr; }
+
   int val_;
 };
 
@@ -32,9 +54,11 @@ enum Binary_op
 struct Binary_expr : Expr
 {
   Binary_expr(int op, Expr const* e1, Expr const* e2)
-    : first(e1), second(e2)
+    : Expr(binary_expr), op(Binary_op(op)), first(e1), second(e2)
   { }
 
+  static bool classof(Expr const* e) { return e->kind() == binary_expr; }
+
   Binary_op   op;
   Expr const* first;
   Expr const* second;
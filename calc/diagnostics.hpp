@@ -0,0 +1,129 @@
+#ifndef DIAGNOSTICS_HPP
+#define DIAGNOSTICS_HPP
+
+#include "string.hpp"
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+
+// -------------------------------------------------------------------------- //
+//                            Diagnostic codes
+
+// The different kinds of diagnostics.
+enum Diagnostic_code : std::uint8_t
+{
+  invalid_character_diag,
+};
+
+
+// -------------------------------------------------------------------------- //
+//                              Diagnostics
+
+// A diagnostic covering the bytes [offset, offset + length)
+// of the input buffer.
+struct Diagnostic
+{
+  Offset          offset;
+  std::uint32_t   length;
+  Diagnostic_code code;
+};
+
+
+// The diagnostic sink collects the diagnostics produced
+// while processing a single input.
+//
+// Diagnostics are recorded as compact entries and
+// written out by a single call to flush(). Adjacent
+// diagnostics of the same kind are coalesced into a
+// single range, so a run of bad bytes is reported once.
+// At most limit() entries are retained; any others are
+// counted but not recorded.
+class Diagnostics
+{
+public:
+  static constexpr std::size_t default_limit = 32;
+
+  explicit Diagnostics(std::size_t = default_limit);
+
+  // Observers
+  bool        empty() const;
+  std::size_t limit() const;
+  std::size_t suppressed() const;
+
+  std::vector<Diagnostic> const& entries() const;
+
+  // Recording
+  void error(Offset, Diagnostic_code);
+
+  // Output
+  void flush(std::ostream&, Stringbuf const&);
+
+private:
+  std::vector<Diagnostic> diags_;      // Recorded diagnostics
+  std::size_t             limit_;      // Maximum recorded entries
+  std::size_t             suppressed_; // Entries past the limit
+};
+
+
+inline
+Diagnostics::Diagnostics(std::size_t n)
+  : diags_(), limit_(n), suppressed_(0)
+{ }
+
+
+// Returns true if no diagnostics have been recorded.
+inline bool
+Diagnostics::empty() const
+{
+  return diags_.empty() && !suppressed_;
+}
+
+
+// Returns the maximum number of recorded entries.
+inline std::size_t
+Diagnostics::limit() const
+{
+  return limit_;
+}
+
+
+// Returns the number of diagnostics that were dropped
+// after the limit was reached.
+inline std::size_t
+Diagnostics::suppressed() const
+{
+  return suppressed_;
+}
+
+
+// Returns the recorded diagnostics.
+inline std::vector<Diagnostic> const&
+Diagnostics::entries() const
+{
+  return diags_;
+}
+
+
+// Record a diagnostic with code c at the byte n. If
+// this immediately follows the previous diagnostic and
+// has the same code, the previous range is extended.
+inline void
+Diagnostics::error(Offset n, Diagnostic_code c)
+{
+  if (!diags_.empty()) {
+    Diagnostic& d = diags_.back();
+    if (d.code == c && d.offset + d.length == n) {
+      ++d.length;
+      return;
+    }
+  }
+  if (diags_.size() < limit_)
+    diags_.push_back({n, 1, c});
+  else
+    ++suppressed_;
+}
+
+
+#endif
@@ -2,9 +2,6 @@
 #include "lexer.hpp"
 
 
-#include <iostream>
-
-
 // Returns the next token in the character stream.
 // If no next token can be identified, an error
 // is emitted and we return the error token.
@@ -13,6 +10,7 @@ Lexer::scan()
 {
   // Consume any white space here.
   space();
+  start_ = cs_.offset();
 
   switch (peek()) {
     case 0: return eof();
@@ -52,7 +50,7 @@ inline Token
 Lexer::on_token()
 {
   Symbol const* sym = syms_.get(build_.take());
-  return Token(sym->token(), sym);
+  return Token(sym->token(), sym, start_);
 }
 
 
@@ -63,13 +61,11 @@ Lexer::on_integer()
   String str = build_.take();
   int n = string_to_int<int>(str, 10);
   Symbol* sym = syms_.put<Integer_sym>(str, integer_tok, n);
-  return Token(integer_tok, sym);
+  return Token(integer_tok, sym, start_);
 }
 
 
 // Consume horizontal and vertical whitespace.
-//
-// TODO: Manage the input location while lexing.
 void
 Lexer::space()
 {
@@ -88,13 +84,15 @@ Lexer::space()
 // Set the error flag and return an invalid token.
 // This also consumes the current character so that
 // we can continue lexing.
+//
+// The error is recorded in the diagnostic sink rather
+// than written immediately.
 inline Token
 Lexer::error()
 {
-  // TODO: Improve diagnostics.
-  std::cerr << "error: invalid character '" << peek() << "'\n";
+  diags_.error(cs_.offset(), invalid_character_diag);
 
   state_ |= error_flag;
-  get();
+  ignore();
   return Token();
 }
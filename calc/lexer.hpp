@@ -4,6 +4,7 @@
 
 #include "string.hpp"
 #include "token.hpp"
+#include "diagnostics.hpp"
 
 #include <cassert>
 #include <cctype>
@@ -11,7 +12,10 @@
 
 // The lexer is responsible for the transformation
 // of a character stream into a list of tokens.
-// FIXME: Maintain source code locations.
+//
+// Each token records the byte offset at which it
+// starts. Lines and columns are not tracked during
+// lexing; see Line_map.
 class Lexer
 {
 public:
@@ -19,7 +23,7 @@ public:
   static constexpr State_flags eof_flag   = 0x01;
   static constexpr State_flags error_flag = 0x02;
 
-  Lexer(Symbol_table&, Char_stream&);
+  Lexer(Symbol_table&, Char_stream&, Diagnostics&);
 
   // Lexer state
   bool done() const;
@@ -62,14 +66,16 @@ private:
 
   String_builder build_; // Cache characters during scan.
   State_flags    state_; // The lexer's state
+  Offset         start_; // The offset of the current token
   Symbol_table&  syms_;  // The symbol table
   Char_stream&   cs_;    // The character stream
+  Diagnostics&   diags_; // The diagnostic sink
 };
 
 
 inline
-Lexer::Lexer(Symbol_table& s, Char_stream& cs)
-  : build_(), state_(0), syms_(s), cs_(cs)
+Lexer::Lexer(Symbol_table& s, Char_stream& cs, Diagnostics& d)
+  : build_(), state_(0), start_(0), syms_(s), cs_(cs), diags_(d)
 { }
 
 
@@ -0,0 +1,53 @@
+#ifndef LOCATION_HPP
+#define LOCATION_HPP
+
+#include "string.hpp"
+
+#include <vector>
+
+
+// -------------------------------------------------------------------------- //
+//                            Source locations
+
+// A resolved source location. Lines and columns are
+// numbered from 1. Columns count bytes.
+struct Location
+{
+  unsigned line;
+  unsigned column;
+};
+
+
+// -------------------------------------------------------------------------- //
+//                              Line map
+
+// The line map translates byte offsets into line and
+// column numbers.
+//
+// The map holds the offset of every newline in the
+// buffer. That index is only built on the first call
+// to resolve(), so inputs that never need a location
+// pay nothing for it. Each lookup is a binary search.
+class Line_map
+{
+public:
+  Line_map(Stringbuf const&);
+
+  Location resolve(Offset) const;
+
+private:
+  void index() const;
+
+  Stringbuf const&            buf_;   // The source buffer
+  mutable std::vector<Offset> lines_; // Offsets of newlines
+  mutable bool                done_;  // True when indexed
+};
+
+
+inline
+Line_map::Line_map(Stringbuf const& b)
+  : buf_(b), lines_(), done_(false)
+{ }
+
+
+#endif
@@ -34,9 +34,12 @@ main(int argc, char* argv[])
   // by the lexer.
   Token_stream ts;
 
-  // Build and run the lexer.
-  Lexer lex(syms, cs);
+  // Build and run the lexer. Lexical errors are collected
+  // by the diagnostic sink and reported once at the end.
+  Diagnostics diags;
+  Lexer lex(syms, cs, diags);
   lex.lex(ts);
+  diags.flush(cerr, cs.buffer());
   if (dont_parse)
     return 0;
 
@@ -4,6 +4,7 @@
 
 #include <cstring>
 #include <algorithm>
+#include <cstdint>
 #include <iosfwd>
 #include <string>
 #include <stdexcept>
@@ -16,6 +17,11 @@
 using String = std::string;
 
 
+// The byte offset of a character within a source buffer.
+// Offsets are 32 bits, so inputs are limited to 4GB.
+using Offset = std::uint32_t;
+
+
 // Returns true if c is the horizontal whitespace.
 // Note that vertical tabs and carriage returns
 // are considered horizontal white space.
@@ -298,6 +304,9 @@ public:
   char get();
 
   Position position() const;
+  Offset   offset() const;
+
+  Stringbuf const& buffer() const;
 
 private:
   Stringbuf buf_; // The shared buffer.
@@ -358,4 +367,21 @@ Char_stream::position() const
 }
 
 
+// Returns the offset of the current character from
+// the start of the buffer.
+inline Offset
+Char_stream::offset() const
+{
+  return pos_ - buf_.begin();
+}
+
+
+// Returns the underlying string buffer.
+inline Stringbuf const&
+Char_stream::buffer() const
+{
+  return buf_;
+}
+
+
 #endif
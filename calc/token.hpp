@@ -38,22 +38,27 @@ enum Token_kind
 // to define their own token enumeration wihtout
 // having to instantiate a new token class.
 //
-// TODO: Keep the source code location.
+// The source location of a token is kept as the byte
+// offset of its first character. Line and column
+// numbers are computed on demand by a Line_map.
 class Token
 {
 public:
   Token();
   Token(int);
   Token(int, Symbol const*);
+  Token(int, Symbol const*, Offset);
 
   explicit operator bool() const;
 
   int           kind() const;
+  Offset        offset() const;
   Symbol const* symbol() const;
   String const& spelling() const;
 
 private:
   int           kind_;
+  Offset        loc_;
   Symbol const* sym_;
 };
 
@@ -76,7 +81,15 @@ Token::Token(int k)
 // symbol table entry.
 inline
 Token::Token(int k, Symbol const* s)
-  : kind_(k), sym_(s)
+  : Token(k, s, 0)
+{ }
+
+
+// Initialize a token of kind k with the given symbol
+// table entry, starting at the byte offset n.
+inline
+Token::Token(int k, Symbol const* s, Offset n)
+  : kind_(k), loc_(n), sym_(s)
 { }
 
 
@@ -97,6 +110,15 @@ Token::kind() const
 }
 
 
+// Returns the byte offset of the token in the
+// source buffer.
+inline Offset
+Token::offset() const
+{
+  return loc_;
+}
+
+
 // Returns the token's symbol and attributes.
 inline Symbol const* 
 Token::symbol() const
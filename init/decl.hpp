@@ -2,12 +2,29 @@
 #ifndef DECL_HPP
 #define DECL_HPP
 
+#include "cast.hpp"
 #include "prelude.hpp"
 #include "symbol.hpp"
 
 
+// The kinds of declarations.
+enum Decl_kind
+{
+  variable_decl,
+};
+
+
 struct Decl
 {
+  Decl(Decl_kind k, Symbol const* n, Type const* t)
+    : kind_(k), first(n), second(t)
+  { }
+
+  static bool classof(Decl const*) { return true; }
+
+  Decl_kind kind() const { return kind_; }
+
+  Decl_kind     kind_;
   Symbol const* first;
   Type const*   second;
 };
@@ -17,6 +34,12 @@ struct Decl
 // A variable declaration.
 struct Variable_decl : Decl
 {
+  Variable_decl(Symbol const* n, Type const* t, Expr const* e)
+    : Decl(variable_decl, n, t), third(e)
+  { }
+
+  static bool classof(Decl const* d) { return d->kind() == variable_decl; }
+
   Expr const* third;
 };
 
@@ -3,13 +3,35 @@
 #define EXPR_HPP
 
 
+#include "cast.hpp"
 #include "prelude.hpp"
 #include "value.hpp"
 
 
+// The kinds of expressions.
+enum Expr_kind
+{
+  constant_expr,
+  tuple_expr,
+  copy_init,
+  direct_init,
+  aggregate_init,
+};
+
+
 struct Expr
 {
+  Expr(Expr_kind k)
+    : kind_(k)
+  { }
+
   virtual ~Expr() { }
+
+  static bool classof(Expr const*) { return true; }
+
+  Expr_kind kind() const { return kind_; }
+
+  Expr_kind kind_;
 };
 
 
@@ -17,9 +39,11 @@ struct Expr
 struct Constant_expr : Expr
 {
   Constant_expr(Value const* v)
-    : value_(v)
+    : Expr(constant_expr), value_(v)
   { }
 
+  static bool classof(Expr const* e) { return e->kind() == constant_expr; }
+
   Value const* value() const { return value_; }
 
   Value const* value_;
@@ -32,9 +56,11 @@ struct Constant_expr : Expr
 struct Tuple_expr : Expr
 {
   Tuple_expr(Expr_seq const& e)
-    : first(e)
+    : Expr(tuple_expr), first(e)
   { }
 
+  static bool classof(Expr const* e) { return e->kind() == tuple_expr; }
+
   Expr_seq const& elements() const { return first; }
 
   Expr_seq first;
@@ -50,6 +76,12 @@ struct Tuple_expr : Expr
 // `e` as an argument.
 struct Copy_init : Expr
 {
+  Copy_init(Expr const* e)
+    : Expr(copy_init), first(e)
+  { }
+
+  static bool classof(Expr const* e) { return e->kind() == copy_init; }
+
   Expr const* first;
 };
 
@@ -62,6 +94,12 @@ struct Copy_init : Expr
 // arguments.
 struct Direct_init : Expr
 {
+  Direct_init(Expr_seq const& e)
+    : Expr(direct_init), first(e)
+  { }
+
+  static bool classof(Expr const* e) { return e->kind() == direct_init; }
+
   Expr_seq first;
 };
 
@@ -76,6 +114,12 @@ struct Direct_init : Expr
 // TODO: Does this invoke a constructor?
 struct Aggregate_init : Expr
 {
+  Aggregate_init(Expr_seq const& e)
+    : Expr(aggregate_init), first(e)
+  { }
+
+  static bool classof(Expr const* e) { return e->kind() == aggregate_init; }
+
   Expr_seq first;
 };
 
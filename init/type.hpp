@@ -2,8 +2,21 @@
 #ifndef TYPE_HPP
 #define TYPE_HPP
 
+#include "cast.hpp"
 #include "prelude.hpp"
 
+#include <stdexcept>
+
+
+// The kinds of types.
+enum Type_kind
+{
+  boolean_type,
+  integer_type,
+  array_type,
+  tuple_type,
+};
+
 
 struct Type_visitor
 {
@@ -17,22 +30,44 @@ struct Type_visitor
 // The base class of all types in the language.
 struct Type
 {
+  Type(Type_kind k)
+    : kind_(k)
+  { }
+
   virtual ~Type() { }
   virtual void accept(Type_visitor&) const = 0;
+
+  static bool classof(Type const*) { return true; }
+
+  Type_kind kind() const { return kind_; }
+
+  Type_kind kind_;
 };
 
 
 // Represents the set of two values (true and false).
 struct Boolean_type : Type
 {
+  Boolean_type()
+    : Type(boolean_type)
+  { }
+
   void accept(Type_visitor& v) const { return v.visit(this); }
+
+  static bool classof(Type const* t) { return t->kind() == boolean_type; }
 };
 
 
 // Represents the set of integer values.
 struct Integer_type : Type
 {
+  Integer_type()
+    : Type(integer_type)
+  { }
+
   void accept(Type_visitor& v) const { return v.visit(this); }
+
+  static bool classof(Type const* t) { return t->kind() == integer_type; }
 };
 
 
@@ -41,8 +76,14 @@ struct Integer_type : Type
 //    t[e]
 struct Array_type : Type
 {
+  Array_type(Type const* t, Expr const* e)
+    : Type(array_type), first(t), second(e)
+  { }
+
   void accept(Type_visitor& v) const { return v.visit(this); }
 
+  static bool classof(Type const* t) { return t->kind() == array_type; }
+
   Type const* type() const { return first; }
   Expr const* extent() const { return second; }
 
@@ -55,9 +96,15 @@ struct Array_type : Type
 // various type.
 //
 //    {t1, ..., tn}
-struct Tuple_type
+struct Tuple_type : Type
 {
-  void accept(Type_visitor& v) { return v.visit(this); }
+  Tuple_type(Type_seq const& t)
+    : Type(tuple_type), first(t)
+  { }
+
+  void accept(Type_visitor& v) const { return v.visit(this); }
+
+  static bool classof(Type const* t) { return t->kind() == tuple_type; }
 
   Type_seq const& types() const     { return first; }
   Type const*     type(int i) const { return first[i]; }
@@ -70,6 +117,11 @@ struct Tuple_type
 // -------------------------------------------------------------------------- //
 //                              Generic visitors
 
+// The generic visitor adapts a function object to the
+// Type_visitor interface. Dispatching through a visitor
+// takes two virtual calls, and requires the result type
+// to be default constructible. Prefer apply(), which
+// does not.
 template<typename F, typename R>
 struct Generic_type_visitor : Type_visitor
 {
@@ -125,12 +177,24 @@ dispatch(Type const* t, F fn)
 }
 
 
-// Apply fn to the propositoin p.
+// Apply fn to the type t. This selects the overload
+// of fn by switching on the kind of t, so the call can
+// be inlined.
 template<typename F, typename R = typename std::result_of<F(Boolean_type const*)>::type>
 inline R
 apply(Type const* t, F fn)
 {
-  return dispatch(t, fn);
+  switch (t->kind()) {
+    case boolean_type:
+      return fn(cast<Boolean_type>(t));
+    case integer_type:
+      return fn(cast<Integer_type>(t));
+    case array_type:
+      return fn(cast<Array_type>(t));
+    case tuple_type:
+      return fn(cast<Tuple_type>(t));
+  }
+  throw std::runtime_error("invalid type");
 }
 
 
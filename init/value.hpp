@@ -91,6 +91,10 @@ Value::accept(Value_visitor& v) const
 // -------------------------------------------------------------------------- //
 //                              Generic visitors
 
+// The generic visitor adapts a function object to the
+// Value_visitor interface. Dispatching through a visitor
+// takes two calls, and requires the result type to be
+// default constructible. Prefer apply(), which does not.
 template<typename F, typename R>
 struct Generic_value_visitor : Value_visitor
 {
@@ -142,12 +146,20 @@ dispatch(Value const& v, F fn)
 }
 
 
-// Apply fn to the propositoin p.
+// Apply fn to the value v. This selects the overload
+// of fn by switching on the kind of v, so the call can
+// be inlined.
 template<typename F, typename R = typename std::result_of<F(Integer_value const&)>::type>
 inline R
 apply(Value const& v, F fn)
 {
-  return dispatch(v, fn);
+  switch (v.kind()) {
+    case integer_value:
+      return fn(v.data_.z);
+    case aggregate_value:
+      return fn(v.data_.a);
+  }
+  throw std::runtime_error("invalid value");
 }
 
 
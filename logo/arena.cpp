@@ -0,0 +1,59 @@
+
+#include "arena.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+
+constexpr std::size_t Arena::block_size;
+
+
+Arena::~Arena()
+{
+  while (first_) {
+    Block* b = first_;
+    first_ = b->next;
+    std::free(b);
+  }
+}
+
+
+// Returns the number of bytes in all blocks.
+std::size_t
+Arena::capacity() const
+{
+  std::size_t n = 0;
+  for (Block* b = first_; b; b = b->next)
+    n += b->size;
+  return n;
+}
+
+
+// Move to the next block that can hold n bytes aligned
+// to a, and allocate from it. Blocks kept from before the
+// last reset are reused when they are large enough;
+// otherwise a new block is inserted after the current one.
+void*
+Arena::grow(std::size_t n, std::size_t a)
+{
+  std::size_t need = n + a;
+  Block* b = cur_ ? cur_->next : first_;
+  if (!b || b->size < need) {
+    std::size_t size = std::max(need, block_size);
+    Block* nb = static_cast<Block*>(std::malloc(sizeof(Block) + size));
+    if (!nb)
+      throw std::bad_alloc();
+    nb->size = size;
+    nb->next = b;
+    if (cur_)
+      cur_->next = nb;
+    else
+      first_ = nb;
+    b = nb;
+  }
+
+  cur_ = b;
+  ptr_ = reinterpret_cast<char*>(b + 1);
+  end_ = ptr_ + b->size;
+  return allocate(n, a);
+}
@@ -0,0 +1,99 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+
+// -------------------------------------------------------------------------- //
+//                                Arena
+
+// An arena is a bump allocator over a chain of memory
+// blocks. Objects are never freed individually; all of
+// them are released at once by reset(). Note that the
+// destructors of objects in the arena are never run.
+//
+// Blocks are kept when the arena is reset and reused
+// by later allocations, so an arena that is reset
+// between records of similar size stops allocating
+// memory after the first few records.
+class Arena
+{
+public:
+  static constexpr std::size_t block_size = 64 * 1024;
+
+  Arena();
+  ~Arena();
+
+  Arena(Arena const&) = delete;
+  Arena& operator=(Arena const&) = delete;
+
+  void* allocate(std::size_t, std::size_t);
+
+  template<typename T, typename... Args>
+  T* make(Args&&...);
+
+  void        reset();
+  std::size_t capacity() const;
+
+private:
+  struct Block
+  {
+    Block*      next;
+    std::size_t size;
+  };
+
+  void* grow(std::size_t, std::size_t);
+
+  Block* first_; // The first block
+  Block* cur_;   // The block being allocated from
+  char*  ptr_;   // The next free byte in the block
+  char*  end_;   // The end of the block
+};
+
+
+inline
+Arena::Arena()
+  : first_(nullptr), cur_(nullptr), ptr_(nullptr), end_(nullptr)
+{ }
+
+
+// Allocate n bytes aligned to a. Note that a must be
+// a power of two.
+inline void*
+Arena::allocate(std::size_t n, std::size_t a)
+{
+  std::size_t pad = -reinterpret_cast<std::size_t>(ptr_) & (a - 1);
+  if (std::size_t(end_ - ptr_) < n + pad)
+    return grow(n, a);
+  char* p = ptr_ + pad;
+  ptr_ = p + n;
+  return p;
+}
+
+
+// Construct a T in the arena with the given arguments.
+template<typename T, typename... Args>
+inline T*
+Arena::make(Args&&... args)
+{
+  void* p = allocate(sizeof(T), alignof(T));
+  return new (p) T(std::forward<Args>(args)...);
+}
+
+
+// Release every object in the arena. This takes
+// constant time.
+inline void
+Arena::reset()
+{
+  cur_ = first_;
+  if (cur_) {
+    ptr_ = reinterpret_cast<char*>(cur_ + 1);
+    end_ = ptr_ + cur_->size;
+  }
+}
+
+
+#endif
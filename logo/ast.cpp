@@ -5,48 +5,258 @@
 
 
 // -------------------------------------------------------------------------- //
-//                              Pretry printing
+//                              Construction
+
+constexpr int Prop_factory::shard_bits;
+constexpr int Prop_factory::shard_count;
+
+
+Prop_factory::Shard::Shard()
+  : table(64, Entry{0, atom_prop, nullptr, nullptr, nullptr}), count(0)
+{ }
+
+
+// Construct a factory. If shared is true, the factory may
+// be used by several threads at once.
+Prop_factory::Prop_factory(bool shared)
+  : epoch_(1), shared_(shared)
+{ }
+
 
-void 
-print(std::ostream& os, Atom const* p)
+Atom const*
+Prop_factory::make_atom(Symbol const* s)
 {
-  os << p->symbol()->spelling();
+  std::uint64_t h = hash_atom(s->spelling().data(), s->spelling().size());
+  return make<Atom>(atom_prop, s, nullptr, h, s);
 }
 
 
-// FIXME: Handle precedence.
+Not const*
+Prop_factory::make_not(Prop const* p)
+{
+  std::uint64_t h = hash_unary(not_seed, p->hash());
+  return make<Not>(not_prop, p, nullptr, h, p);
+}
+
+
+And const*
+Prop_factory::make_and(Prop const* p1, Prop const* p2)
+{
+  std::uint64_t h = hash_binary(and_seed, p1->hash(), p2->hash());
+  return make<And>(and_prop, p1, p2, h, p1, p2);
+}
+
+
+Or const*
+Prop_factory::make_or(Prop const* p1, Prop const* p2)
+{
+  std::uint64_t h = hash_binary(or_seed, p1->hash(), p2->hash());
+  return make<Or>(or_prop, p1, p2, h, p1, p2);
+}
+
+
+Implies const*
+Prop_factory::make_implies(Prop const* p1, Prop const* p2)
+{
+  std::uint64_t h = hash_binary(implies_seed, p1->hash(), p2->hash());
+  return make<Implies>(implies_prop, p1, p2, h, p1, p2);
+}
+
+
+// Returns the number of distinct nodes created since
+// the last reset.
+std::size_t
+Prop_factory::size() const
+{
+  std::size_t n = 0;
+  for (Shard const& s : shards_)
+    n += s.count;
+  return n;
+}
+
+
+// Release all propositions created by the factory.
+// Entries of the unique table are invalidated by moving
+// to a new epoch, so this takes constant time.
 void
-print(std::ostream& os, And const* p)
+Prop_factory::reset()
 {
-  os << '(' << p->left() << ')'<< " and " << '(' << p->right() << ')';
+  for (Shard& s : shards_) {
+    s.arena.reset();
+    s.count = 0;
+  }
+  if (++epoch_ == 0) {
+    for (Shard& s : shards_) {
+      for (Entry& e : s.table)
+        e.epoch = 0;
+    }
+    epoch_ = 1;
+  }
 }
 
 
-// FIXME: Handle precedence.
+// Returns the unique node for the key (k, a, b), whose
+// structural hash is h. If there is no such node, a new
+// T is constructed with args. A shared factory selects
+// the shard by the high bits of the hash, and locks it.
+template<typename T, typename... Args>
+T const*
+Prop_factory::make(Prop_kind k, void const* a, void const* b, std::uint64_t h, Args... args)
+{
+  Shard& s = shards_[shared_ ? h >> (64 - shard_bits) : 0];
+  std::unique_lock<std::mutex> lock(s.mutex, std::defer_lock);
+  if (shared_)
+    lock.lock();
+
+  Entry& e = lookup(s, k, a, b, h);
+  if (!e.node)
+    e.node = s.arena.make<T>(args...);
+  return static_cast<T const*>(e.node);
+}
+
+
+// Returns the entry for the key (k, a, b) in the shard s,
+// where h is the structural hash of the node with that
+// key. If there is no such entry, a new one is added,
+// with a null node for the caller to fill in.
+Prop_factory::Entry&
+Prop_factory::lookup(Shard& s, Prop_kind k, void const* a, void const* b, std::uint64_t h)
+{
+  if (2 * (s.count + 1) > s.table.size())
+    rehash(s);
+
+  std::size_t mask = s.table.size() - 1;
+  std::size_t i = h & mask;
+  while (true) {
+    Entry& e = s.table[i];
+    if (e.epoch != epoch_) {
+      e = Entry{epoch_, k, a, b, nullptr};
+      ++s.count;
+      return e;
+    }
+    if (e.kind == k && e.first == a && e.second == b)
+      return e;
+    i = (i + 1) & mask;
+  }
+}
+
+
+// Double the size of the table of the shard s.
 void
-print(std::ostream& os, Or const* p)
+Prop_factory::rehash(Shard& s)
 {
-  os << '(' << p->left() << ')'<< " or " << '(' << p->right() << ')';
+  std::vector<Entry> old(2 * s.table.size(), Entry{0, atom_prop, nullptr, nullptr, nullptr});
+  old.swap(s.table);
+  std::size_t mask = s.table.size() - 1;
+  for (Entry const& e : old) {
+    if (e.epoch != epoch_)
+      continue;
+    std::size_t i = e.node->hash() & mask;
+    while (s.table[i].epoch == epoch_)
+      i = (i + 1) & mask;
+    s.table[i] = e;
+  }
 }
 
 
-void 
-print(std::ostream& os, Prop const* p)
+// -------------------------------------------------------------------------- //
+//                                Editing
+
+// Returns the proposition p with the subproposition at
+// path replaced by q. Only the nodes along the path are
+// rebuilt; all other subpropositions of the result are
+// shared with p.
+Prop const*
+replace(Prop_factory& f, Prop const* p, Path const& path, Prop const* q)
 {
-  struct Fn
-  {
-    Fn(std::ostream& os)
-      : os(os)
-    { }
+  std::vector<Prop const*> nodes;
+  for (int step : path) {
+    nodes.push_back(p);
+    if (Not const* n = as<Not>(p)) {
+      if (step)
+        throw std::out_of_range("invalid path");
+      p = n->operand();
+    } else {
+      Binary const* b = cast<Binary>(p);
+      p = step ? b->right() : b->left();
+    }
+  }
+
+  for (std::size_t i = nodes.size(); i-- > 0; ) {
+    if (is<Not>(nodes[i])) {
+      q = f.make_not(q);
+      continue;
+    }
+    Binary const* b = static_cast<Binary const*>(nodes[i]);
+    Prop const* l = path[i] ? b->left() : q;
+    Prop const* r = path[i] ? q : b->right();
+    switch (b->kind()) {
+      case and_prop:
+        q = f.make_and(l, r);
+        break;
+      case or_prop:
+        q = f.make_or(l, r);
+        break;
+      default:
+        q = f.make_implies(l, r);
+        break;
+    }
+  }
+  return q;
+}
 
-    void operator()(Atom const* p) const { print(os, p); }
-    void operator()(And const* p) const { print(os, p); }
-    void operator()(Or const* p) const { print(os, p); }
 
-    std::ostream& os;
+// -------------------------------------------------------------------------- //
+//                              Pretry printing
+
+// Print the proposition p. The operands of negations and
+// binary propositions are fully parenthesized.
+//
+// The output is produced from an explicit stack of pending
+// items, each of which is either a proposition or a piece
+// of punctuation, so p may be arbitrarily deep.
+//
+// FIXME: Handle precedence.
+void
+print(std::ostream& os, Prop const* p)
+{
+  struct Item
+  {
+    Prop const* p;
+    char const* text; // Printed when p is null
   };
-  
-  apply(p, Fn(os));
+
+  std::vector<Item> work {{p, nullptr}};
+  while (!work.empty()) {
+    Item i = work.back();
+    work.pop_back();
+    if (!i.p) {
+      os << i.text;
+      continue;
+    }
+    switch (i.p->kind()) {
+      case atom_prop:
+        os << cast<Atom>(i.p)->symbol()->spelling();
+        break;
+      case not_prop:
+        work.push_back({nullptr, ")"});
+        work.push_back({cast<Not>(i.p)->operand(), nullptr});
+        work.push_back({nullptr, "not ("});
+        break;
+      case and_prop:
+      case or_prop:
+      case implies_prop: {
+        static char const* ops[] = {nullptr, nullptr, ") and (", ") or (", ") -> ("};
+        Binary const* b = cast<Binary>(i.p);
+        work.push_back({nullptr, ")"});
+        work.push_back({b->right(), nullptr});
+        work.push_back({nullptr, ops[b->kind()]});
+        work.push_back({b->left(), nullptr});
+        work.push_back({nullptr, "("});
+        break;
+      }
+    }
+  }
 }
 
 
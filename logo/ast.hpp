@@ -2,29 +2,76 @@
 #ifndef AST_HPP
 #define AST_HPP
 
+#include "arena.hpp"
 #include "cast.hpp"
+#include "hash.hpp"
 #include "symbol.hpp"
 
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
 struct Prop;
 struct Atom;
+struct Not;
 struct And;
 struct Or;
+struct Implies;
+
+
+// The kinds of propositions.
+enum Prop_kind : std::uint8_t
+{
+  atom_prop,
+  not_prop,
+  and_prop,
+  or_prop,
+  implies_prop,
+};
 
 
 // The visitor class.
 struct Visitor
 {
   virtual void visit(Atom const*) = 0;
+  virtual void visit(Not const*) = 0;
   virtual void visit(And const*) = 0;
   virtual void visit(Or const*) = 0;
+  virtual void visit(Implies const*) = 0;
 };
 
 
 // The base class of all logical propositions.
+//
+// Each proposition stores its kind, which is used by
+// the casting operations, and its structural hash, which
+// is computed when it is constructed. See hash.hpp for
+// the definition of the hash.
+//
+// The size of a proposition is the number of nodes in its
+// tree, counting shared subtrees once for each occurrence.
+// It estimates the work of a traversal, and saturates at
+// the largest 32-bit value.
 struct Prop
 {
+  Prop(Prop_kind k, std::uint32_t n, std::uint64_t h)
+    : kind_(k), size_(n), hash_(h)
+  { }
+
   virtual ~Prop() { }
   virtual void accept(Visitor& v) const = 0;
+
+  static bool classof(Prop const*) { return true; }
+
+  Prop_kind     kind() const { return kind_; }
+  std::uint32_t size() const { return size_; }
+  std::uint64_t hash() const { return hash_; }
+
+  Prop_kind     kind_;
+  std::uint32_t size_;
+  std::uint64_t hash_;
 };
 
 
@@ -32,24 +79,59 @@ struct Prop
 struct Atom : Prop
 {
   Atom(Symbol const* s)
-    : sym_(s)
+    : Prop(atom_prop, 1, hash_atom(s->spelling().data(), s->spelling().size())), sym_(s)
   { }
 
   void accept(Visitor& v) const { return v.visit(this); }
 
+  static bool classof(Prop const* p) { return p->kind() == atom_prop; }
+
   Symbol const* symbol() const { return sym_; }
 
   Symbol const* sym_;
 };
 
 
+// Negation of a proposition.
+struct Not : Prop
+{
+  Not(Prop const* e)
+    : Prop(not_prop, size_of(e), hash_unary(not_seed, e->hash())), first(e)
+  { }
+
+  // Returns the size of a node with operand e.
+  static std::uint32_t size_of(Prop const* e)
+  {
+    std::uint64_t n = 1 + std::uint64_t(e->size());
+    return std::min<std::uint64_t>(n, std::numeric_limits<std::uint32_t>::max());
+  }
+
+  void accept(Visitor& v) const { return v.visit(this); }
+
+  static bool classof(Prop const* p) { return p->kind() == not_prop; }
+
+  Prop const* operand() const { return first; }
+
+  Prop const* first;
+};
+
+
 // A helper class.
 struct Binary : Prop
 {
-  Binary(Prop const* e1, Prop const* e2)
-    : first(e1), second(e2)
+  Binary(Prop_kind k, std::uint64_t seed, Prop const* e1, Prop const* e2)
+    : Prop(k, size_of(e1, e2), hash_binary(seed, e1->hash(), e2->hash())), first(e1), second(e2)
   { }
 
+  // Returns the size of a node with operands e1 and e2.
+  static std::uint32_t size_of(Prop const* e1, Prop const* e2)
+  {
+    std::uint64_t n = 1 + std::uint64_t(e1->size()) + e2->size();
+    return std::min<std::uint64_t>(n, std::numeric_limits<std::uint32_t>::max());
+  }
+
+  static bool classof(Prop const* p) { return p->kind() >= and_prop; }
+
   Prop const* left() const { return first; }
   Prop const* right() const { return second; }
 
@@ -61,21 +143,147 @@ struct Binary : Prop
 // Conjunction of propositions.
 struct And : Binary
 {
-  using Binary::Binary;
+  And(Prop const* e1, Prop const* e2)
+    : Binary(and_prop, and_seed, e1, e2)
+  { }
 
   void accept(Visitor& v) const { return v.visit(this); }
+
+  static bool classof(Prop const* p) { return p->kind() == and_prop; }
 };
 
 
 // Disjunction of propositions.
 struct Or : Binary
 {
-  using Binary::Binary;
-  
+  Or(Prop const* e1, Prop const* e2)
+    : Binary(or_prop, or_seed, e1, e2)
+  { }
+
   void accept(Visitor& v) const { return v.visit(this); }
+
+  static bool classof(Prop const* p) { return p->kind() == or_prop; }
+};
+
+
+// Implication of propositions.
+struct Implies : Binary
+{
+  Implies(Prop const* e1, Prop const* e2)
+    : Binary(implies_prop, implies_seed, e1, e2)
+  { }
+
+  void accept(Visitor& v) const { return v.visit(this); }
+
+  static bool classof(Prop const* p) { return p->kind() == implies_prop; }
 };
 
 
+// -------------------------------------------------------------------------- //
+//                              Construction
+
+// The proposition factory creates and owns propositions.
+//
+// Propositions are hash-consed: the factory keeps a
+// table of the nodes it has created, indexed by their
+// structural hashes, and returns the
+// existing node when asked to make one with the same
+// operator and operands. Because operands are themselves
+// unique, two propositions from the same factory are
+// structurally equal if and only if they are the same
+// node.
+//
+// Nodes are allocated in an arena and are never freed
+// individually. All nodes created by the factory are
+// released at once by reset(), which takes constant
+// time, or when the factory is destroyed. Any pointers
+// to those nodes (including those held in a parse cache)
+// are invalidated.
+//
+// A shared factory may be used by several threads at once,
+// except for reset(). Its table is divided into shards by
+// hash, each with its own lock and arena, so that threads
+// creating different nodes rarely contend. A factory that
+// is not shared has one shard and takes no locks.
+class Prop_factory
+{
+public:
+  static constexpr int shard_bits = 4;
+  static constexpr int shard_count = 1 << shard_bits;
+
+  explicit Prop_factory(bool = false);
+
+  Prop_factory(Prop_factory const&) = delete;
+  Prop_factory& operator=(Prop_factory const&) = delete;
+
+  Atom const*    make_atom(Symbol const*);
+  Not const*     make_not(Prop const*);
+  And const*     make_and(Prop const*, Prop const*);
+  Or const*      make_or(Prop const*, Prop const*);
+  Implies const* make_implies(Prop const*, Prop const*);
+
+  bool        shared() const;
+  std::size_t size() const;
+
+  void reset();
+
+private:
+  // An entry in the unique table. Entries from before
+  // the last reset have an old epoch and are empty.
+  struct Entry
+  {
+    unsigned    epoch;
+    Prop_kind   kind;
+    void const* first;
+    void const* second;
+    Prop const* node;
+  };
+
+  // A part of the unique table, and the storage for the
+  // nodes in it.
+  struct Shard
+  {
+    Shard();
+
+    std::mutex         mutex; // Guards the shard when shared
+    Arena              arena; // Storage for nodes
+    std::vector<Entry> table; // The unique table
+    std::size_t        count; // Number of live entries
+  };
+
+  template<typename T, typename... Args>
+  T const* make(Prop_kind, void const*, void const*, std::uint64_t, Args...);
+
+  Entry& lookup(Shard&, Prop_kind, void const*, void const*, std::uint64_t);
+  void   rehash(Shard&);
+
+  Shard    shards_[shard_count]; // The shards of the table
+  unsigned epoch_;               // The current epoch
+  bool     shared_;              // True if used by many threads
+};
+
+
+// Returns true if the factory may be used by several
+// threads at once.
+inline bool
+Prop_factory::shared() const
+{
+  return shared_;
+}
+
+
+// -------------------------------------------------------------------------- //
+//                                Editing
+
+// A path selects a subproposition by a sequence of steps
+// from the root. Each step selects the left (0) or right
+// (1) operand of a binary proposition, or the operand (0)
+// of a negation.
+using Path = std::vector<int>;
+
+Prop const* replace(Prop_factory&, Prop const*, Path const&, Prop const*);
+
+
 // -------------------------------------------------------------------------- //
 //                                Operations
 
@@ -87,6 +295,10 @@ std::ostream& operator<<(std::ostream&, Prop const*);
 // -------------------------------------------------------------------------- //
 //                              Generic visitors
 
+// The generic visitor adapts a function object to the
+// Visitor interface. Dispatching through a visitor takes
+// two virtual calls, and requires the result type to be
+// default constructible. Prefer apply(), which does not.
 template<typename F, typename R>
 struct Generic_visitor : Visitor
 {
@@ -95,8 +307,10 @@ struct Generic_visitor : Visitor
   { }
   
   void visit(Atom const* p) { r = fn(p); }
+  void visit(Not const* p) { r = fn(p); }
   void visit(And const* p) { r = fn(p); }
   void visit(Or const* p) { r = fn(p); }
+  void visit(Implies const* p) { r = fn(p); }
 
   F fn;
   R r;
@@ -112,8 +326,10 @@ struct Generic_visitor<F, void> : Visitor
   { }
   
   void visit(Atom const* p) { fn(p); }
+  void visit(Not const* p) { fn(p); }
   void visit(And const* p) { fn(p); }
   void visit(Or const* p) { fn(p); }
+  void visit(Implies const* p) { fn(p); }
 
   F fn;
 };
@@ -140,12 +356,103 @@ dispatch(Prop const* p, F fn)
 }
 
 
-// Apply fn to the propositoin p.
+// Apply fn to the proposition p. This selects the
+// overload of fn by switching on the kind of p, so the
+// call can be inlined.
 template<typename F, typename R = typename std::result_of<F(Atom const*)>::type>
 inline R
 apply(Prop const* p, F fn)
 {
-  return dispatch(p, fn);
+  switch (p->kind()) {
+    case atom_prop:
+      return fn(cast<Atom>(p));
+    case not_prop:
+      return fn(cast<Not>(p));
+    case and_prop:
+      return fn(cast<And>(p));
+    case or_prop:
+      return fn(cast<Or>(p));
+    case implies_prop:
+      return fn(cast<Implies>(p));
+  }
+  throw std::runtime_error("invalid proposition");
+}
+
+
+// -------------------------------------------------------------------------- //
+//                              Traversal
+
+// Compute a value of type R for the proposition p from
+// the bottom up. For each occurrence of a node in p, fn is
+// called after its operands as:
+//
+//    fn(Atom const*)
+//    fn(Not const*, R operand)
+//    fn(And const*, R left, R right)
+//    fn(Or const*, R left, R right)
+//    fn(Implies const*, R left, R right)
+//
+// where operand, left and right are the values computed
+// for its operands. The traversal uses an explicit stack,
+// so the depth of p is limited only by available memory.
+template<typename R, typename F>
+R
+fold(Prop const* p, F fn)
+{
+  struct Frame
+  {
+    Prop const* p;
+    bool        done; // True if the last operand was entered
+  };
+
+  // Descend along left operands, pushing a frame for each
+  // negation and binary node, and compute the value of the
+  // leftmost atom. The frame of a negation is done as soon
+  // as it is pushed. Then pop each frame whose operands are
+  // finished, and descend into the right operand of the
+  // first that is not.
+  std::vector<Frame> work;
+  std::vector<R>     vals;
+  while (true) {
+    while (p->kind() != atom_prop) {
+      if (p->kind() == not_prop) {
+        work.push_back({p, true});
+        p = static_cast<Not const*>(p)->operand();
+      } else {
+        work.push_back({p, false});
+        p = static_cast<Binary const*>(p)->left();
+      }
+    }
+    vals.push_back(fn(static_cast<Atom const*>(p)));
+
+    while (!work.empty() && work.back().done) {
+      Prop const* q = work.back().p;
+      work.pop_back();
+      if (q->kind() == not_prop) {
+        R& x = vals.back();
+        x = fn(static_cast<Not const*>(q), std::move(x));
+        continue;
+      }
+      R r = std::move(vals.back());
+      vals.pop_back();
+      R& l = vals.back();
+      switch (q->kind()) {
+        case and_prop:
+          l = fn(static_cast<And const*>(q), std::move(l), std::move(r));
+          break;
+        case or_prop:
+          l = fn(static_cast<Or const*>(q), std::move(l), std::move(r));
+          break;
+        default:
+          l = fn(static_cast<Implies const*>(q), std::move(l), std::move(r));
+          break;
+      }
+    }
+    if (work.empty())
+      return std::move(vals.back());
+    work.back().done = true;
+    p = static_cast<Binary const*>(work.back().p)->right();
+  }
 }
 
 
@@ -0,0 +1,454 @@
+
+#include "bdd.hpp"
+#include "ast.hpp"
+#include "hash.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+
+constexpr std::uint32_t Bdd_manager::no_node;
+constexpr std::uint32_t Bdd_manager::one_edge;
+constexpr std::uint32_t Bdd_manager::zero_edge;
+
+
+namespace
+{
+
+// Sizes of the tables, in entries.
+constexpr std::size_t min_buckets = 1 << 10;
+constexpr std::size_t min_cache   = 1 << 10;
+constexpr std::size_t max_cache   = 1 << 20;
+constexpr std::size_t first_gc    = 1 << 16;
+
+
+// Returns the largest power of two that is at most n.
+inline std::size_t
+floor_pow2(std::size_t n)
+{
+  std::size_t p = 1;
+  while (2 * p <= n)
+    p *= 2;
+  return p;
+}
+
+
+// Returns a hash of three words.
+inline std::size_t
+hash_triple(std::uint32_t a, std::uint32_t b, std::uint32_t c)
+{
+  std::uint64_t x = std::uint64_t(a) << 32 | b;
+  return hash_mix(x ^ hash_secret[0], c ^ hash_secret[1]);
+}
+
+} // namespace
+
+
+// Construct a manager whose nodes, unique table and
+// operation cache use about the given number of bytes.
+Bdd_manager::Bdd_manager(std::size_t bytes)
+  : buckets_(min_buckets, no_node)
+  , free_(no_node)
+  , live_(1)
+  , stats_{1, 1, 0, 0, 0, 0}
+{
+  // Each node also takes about one word of the unique
+  // table. A quarter of the nodes fit in the cache.
+  std::size_t node = sizeof(Node) + sizeof(std::uint32_t) + sizeof(Entry) / 4;
+  limit_ = std::min<std::size_t>(std::max<std::size_t>(bytes / node, 2), std::size_t(1) << 31);
+  next_gc_ = std::min(first_gc, limit_);
+
+  std::size_t cache = floor_pow2(limit_ / 4);
+  cache = std::max(min_cache, std::min(max_cache, cache));
+  cache_.assign(cache, Entry{no_node, no_node, no_node, no_node});
+
+  // The terminal is never freed.
+  nodes_.push_back(Node{no_node, one_edge, one_edge, no_node, 1});
+}
+
+
+// -------------------------------------------------------------------------- //
+//                              Construction
+
+Bdd
+Bdd_manager::one()
+{
+  return wrap(one_edge);
+}
+
+
+Bdd
+Bdd_manager::zero()
+{
+  return wrap(zero_edge);
+}
+
+
+// Returns the BDD of the atom s, creating its variable
+// if s has not been seen before.
+Bdd
+Bdd_manager::var(Symbol const* s)
+{
+  prepare();
+  auto iter = vars_.find(s);
+  if (iter == vars_.end())
+    iter = vars_.emplace(s, vars_.size()).first;
+  std::uint32_t v = iter->second;
+  try {
+    return wrap(make(v, zero_edge, one_edge));
+  } catch (std::length_error&) {
+    collect();
+    return wrap(make(v, zero_edge, one_edge));
+  }
+}
+
+
+// Negation complements the edge, and creates no nodes.
+Bdd
+Bdd_manager::make_not(Bdd const& a)
+{
+  assert(a.mgr_ == this);
+  return wrap(a.edge_ ^ 1);
+}
+
+
+Bdd
+Bdd_manager::make_and(Bdd const& a, Bdd const& b)
+{
+  assert(a.mgr_ == this && b.mgr_ == this);
+  return wrap(run(a.edge_, b.edge_, zero_edge));
+}
+
+
+Bdd
+Bdd_manager::make_or(Bdd const& a, Bdd const& b)
+{
+  assert(a.mgr_ == this && b.mgr_ == this);
+  return wrap(run(a.edge_, one_edge, b.edge_));
+}
+
+
+Bdd
+Bdd_manager::make_implies(Bdd const& a, Bdd const& b)
+{
+  assert(a.mgr_ == this && b.mgr_ == this);
+  return wrap(run(a.edge_, b.edge_, one_edge));
+}
+
+
+// Returns the BDD of (f and g) or (not f and h).
+Bdd
+Bdd_manager::ite(Bdd const& f, Bdd const& g, Bdd const& h)
+{
+  assert(f.mgr_ == this && g.mgr_ == this && h.mgr_ == this);
+  return wrap(run(f.edge_, g.edge_, h.edge_));
+}
+
+
+// Returns the BDD of the proposition p.
+//
+// Each distinct node of p is compiled once, after its
+// operands, by selecting the operation for its kind with
+// apply(). Nodes are visited from an explicit stack, so p
+// may be arbitrarily deep.
+Bdd
+Bdd_manager::compile(Prop const* p)
+{
+  using Memo = std::unordered_map<Prop const*, Bdd>;
+
+  struct Fn
+  {
+    Bdd operator()(Atom const* p) const { return m.var(p->symbol()); }
+    Bdd operator()(Not const* p) const { return m.make_not(get(p->operand())); }
+    Bdd operator()(And const* p) const { return m.make_and(get(p->left()), get(p->right())); }
+    Bdd operator()(Or const* p) const { return m.make_or(get(p->left()), get(p->right())); }
+    Bdd operator()(Implies const* p) const { return m.make_implies(get(p->left()), get(p->right())); }
+
+    Bdd const& get(Prop const* p) const { return memo.find(p)->second; }
+
+    Bdd_manager& m;
+    Memo&        memo;
+  };
+
+  Memo memo;
+  std::vector<Prop const*> work {p};
+  while (!work.empty()) {
+    Prop const* q = work.back();
+    if (memo.count(q)) {
+      work.pop_back();
+      continue;
+    }
+
+    // Compile the operands of a node before the node.
+    std::size_t n = work.size();
+    if (Not const* r = as<Not>(q)) {
+      if (!memo.count(r->operand()))
+        work.push_back(r->operand());
+    } else if (Binary const* r = as<Binary>(q)) {
+      if (!memo.count(r->right()))
+        work.push_back(r->right());
+      if (!memo.count(r->left()))
+        work.push_back(r->left());
+    }
+    if (work.size() != n)
+      continue;
+    work.pop_back();
+
+    memo.emplace(q, apply(q, Fn{*this, memo}));
+  }
+  return memo.find(p)->second;
+}
+
+
+// -------------------------------------------------------------------------- //
+//                                Queries
+
+// Returns the number of nodes of the BDD a, including
+// the terminal.
+std::size_t
+Bdd_manager::count(Bdd const& a) const
+{
+  assert(a.mgr_ == this);
+  std::vector<char> seen(nodes_.size());
+  std::vector<std::uint32_t> work {a.edge_ >> 1};
+  std::size_t n = 0;
+  while (!work.empty()) {
+    std::uint32_t i = work.back();
+    work.pop_back();
+    if (seen[i])
+      continue;
+    seen[i] = 1;
+    ++n;
+    if (i != 0) {
+      work.push_back(nodes_[i].low >> 1);
+      work.push_back(nodes_[i].high >> 1);
+    }
+  }
+  return n;
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Garbage collection
+
+// Collect garbage before an operation if the number of
+// nodes has reached the threshold. If most nodes survive,
+// the threshold is raised, up to the limit.
+void
+Bdd_manager::prepare()
+{
+  if (live_ < next_gc_)
+    return;
+  collect();
+  if (2 * live_ > next_gc_)
+    next_gc_ = std::min(2 * next_gc_, limit_);
+}
+
+
+// Returns the edge of ite(f, g, h), whose arguments are
+// referenced. If the operation runs out of nodes, it is
+// retried once after collecting garbage, which cannot be
+// done during the operation because its intermediate
+// results are not referenced.
+std::uint32_t
+Bdd_manager::run(std::uint32_t f, std::uint32_t g, std::uint32_t h)
+{
+  prepare();
+  try {
+    return ite(f, g, h);
+  } catch (std::length_error&) {
+    collect();
+    return ite(f, g, h);
+  }
+}
+
+
+// Free every node that is not reachable from a referenced
+// node. The unique table is rebuilt from the surviving
+// nodes, and the operation cache is cleared, since its
+// entries may name freed nodes.
+void
+Bdd_manager::collect()
+{
+  std::vector<char> mark(nodes_.size());
+  std::vector<std::uint32_t> work;
+  for (std::uint32_t i = 0; i < nodes_.size(); ++i) {
+    if (nodes_[i].refs)
+      work.push_back(i);
+  }
+  while (!work.empty()) {
+    std::uint32_t i = work.back();
+    work.pop_back();
+    if (mark[i])
+      continue;
+    mark[i] = 1;
+    if (i != 0) {
+      work.push_back(nodes_[i].low >> 1);
+      work.push_back(nodes_[i].high >> 1);
+    }
+  }
+
+  for (std::uint32_t i = 1; i < nodes_.size(); ++i) {
+    Node& n = nodes_[i];
+    if (n.var == no_node || mark[i])
+      continue;
+    n.var = no_node;
+    n.next = free_;
+    free_ = i;
+    --live_;
+    ++stats_.freed;
+  }
+  rehash(buckets_.size());
+  for (Entry& e : cache_)
+    e.f = no_node;
+
+  stats_.nodes = live_;
+  ++stats_.collections;
+}
+
+
+// -------------------------------------------------------------------------- //
+//                              Operations
+
+// Returns the variable at the root of the edge e. The
+// terminal has the last variable.
+inline std::uint32_t
+Bdd_manager::top(std::uint32_t e) const
+{
+  return nodes_[e >> 1].var;
+}
+
+
+// Returns the cofactor of the edge e where v is false.
+inline std::uint32_t
+Bdd_manager::low(std::uint32_t e, std::uint32_t v) const
+{
+  Node const& n = nodes_[e >> 1];
+  return n.var == v ? n.low ^ (e & 1) : e;
+}
+
+
+// Returns the cofactor of the edge e where v is true.
+inline std::uint32_t
+Bdd_manager::high(std::uint32_t e, std::uint32_t v) const
+{
+  Node const& n = nodes_[e >> 1];
+  return n.var == v ? n.high ^ (e & 1) : e;
+}
+
+
+// Returns the edge to the node (v, lo, hi), creating it if
+// it does not exist. The high edge of a stored node is
+// never complemented; if hi is complemented, the node of
+// the complements is used and the result is complemented.
+std::uint32_t
+Bdd_manager::make(std::uint32_t v, std::uint32_t lo, std::uint32_t hi)
+{
+  if (lo == hi)
+    return lo;
+  std::uint32_t neg = hi & 1;
+  lo ^= neg;
+  hi ^= neg;
+
+  std::size_t b = hash_triple(v, lo, hi) & (buckets_.size() - 1);
+  for (std::uint32_t i = buckets_[b]; i != no_node; i = nodes_[i].next) {
+    Node const& n = nodes_[i];
+    if (n.var == v && n.low == lo && n.high == hi)
+      return i << 1 | neg;
+  }
+
+  std::uint32_t i;
+  if (free_ != no_node) {
+    i = free_;
+    free_ = nodes_[i].next;
+  } else {
+    if (nodes_.size() >= limit_)
+      throw std::length_error("BDD node limit exceeded");
+    i = nodes_.size();
+    nodes_.emplace_back();
+  }
+  nodes_[i] = Node{v, lo, hi, buckets_[b], 0};
+  buckets_[b] = i;
+
+  ++live_;
+  stats_.nodes = live_;
+  stats_.peak = std::max(stats_.peak, live_);
+  if (live_ > buckets_.size())
+    rehash(2 * buckets_.size());
+  return i << 1 | neg;
+}
+
+
+// Returns the edge of ite(f, g, h).
+//
+// After the terminal cases, the arguments are normalized
+// so that equivalent calls share cache entries: f and g
+// are made regular, complementing the result if needed.
+// Then the result is built from the cofactors of the
+// arguments for the top variable.
+std::uint32_t
+Bdd_manager::ite(std::uint32_t f, std::uint32_t g, std::uint32_t h)
+{
+  // Replace g and h by constants where f decides them.
+  if (g == f)
+    g = one_edge;
+  else if (g == (f ^ 1))
+    g = zero_edge;
+  if (h == f)
+    h = zero_edge;
+  else if (h == (f ^ 1))
+    h = one_edge;
+
+  if (f == one_edge || g == h)
+    return g;
+  if (f == zero_edge)
+    return h;
+  if (g == one_edge && h == zero_edge)
+    return f;
+  if (g == zero_edge && h == one_edge)
+    return f ^ 1;
+
+  // ite(-f, g, h) = ite(f, h, g), and
+  // ite(f, -g, h) = -ite(f, g, -h).
+  if (f & 1) {
+    f ^= 1;
+    std::swap(g, h);
+  }
+  std::uint32_t neg = g & 1;
+  g ^= neg;
+  h ^= neg;
+
+  ++stats_.lookups;
+  Entry& e = cache_[hash_triple(f, g, h) & (cache_.size() - 1)];
+  if (e.f == f && e.g == g && e.h == h) {
+    ++stats_.hits;
+    return e.result ^ neg;
+  }
+
+  std::uint32_t v = std::min(top(f), std::min(top(g), top(h)));
+  std::uint32_t t = ite(high(f, v), high(g, v), high(h, v));
+  std::uint32_t l = ite(low(f, v), low(g, v), low(h, v));
+  std::uint32_t r = make(v, l, t);
+
+  // The entry may have been replaced by the recursive calls.
+  Entry& x = cache_[hash_triple(f, g, h) & (cache_.size() - 1)];
+  x = Entry{f, g, h, r};
+  return r ^ neg;
+}
+
+
+// Rebuild the unique table with n buckets.
+void
+Bdd_manager::rehash(std::size_t n)
+{
+  buckets_.assign(n, no_node);
+  for (std::uint32_t i = 1; i < nodes_.size(); ++i) {
+    Node& x = nodes_[i];
+    if (x.var == no_node)
+      continue;
+    std::size_t b = hash_triple(x.var, x.low, x.high) & (n - 1);
+    x.next = buckets_[b];
+    buckets_[b] = i;
+  }
+}
@@ -0,0 +1,299 @@
+#ifndef BDD_HPP
+#define BDD_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+
+struct Prop;
+class Symbol;
+class Bdd_manager;
+
+
+// -------------------------------------------------------------------------- //
+//                                  BDDs
+
+// A reference to a node of a reduced ordered binary
+// decision diagram (ROBDD), owned by a BDD manager.
+//
+// BDDs are canonical: two BDDs from the same manager
+// represent the same boolean function if and only if they
+// are equal, which compares a single word. A BDD keeps its
+// node alive; nodes that are not referenced by any BDD
+// are reclaimed by garbage collection.
+class Bdd
+{
+  friend class Bdd_manager;
+public:
+  Bdd();
+  Bdd(Bdd const&);
+  ~Bdd();
+
+  Bdd& operator=(Bdd const&);
+
+  bool is_one() const;
+  bool is_zero() const;
+
+  Bdd_manager* manager() const;
+
+  friend bool operator==(Bdd const& a, Bdd const& b);
+  friend bool operator!=(Bdd const& a, Bdd const& b);
+
+private:
+  Bdd(Bdd_manager*, std::uint32_t);
+
+  Bdd_manager*  mgr_;
+  std::uint32_t edge_; // Node index, and a complement bit
+};
+
+
+// Statistics of a BDD manager.
+struct Bdd_stats
+{
+  std::size_t   nodes;       // Allocated nodes
+  std::size_t   peak;        // Most nodes allocated at once
+  std::uint64_t lookups;     // Operation cache lookups
+  std::uint64_t hits;        // Operation cache hits
+  std::size_t   collections; // Garbage collections
+  std::size_t   freed;       // Nodes freed by collection
+};
+
+
+// The default limit on the memory used for BDD nodes.
+constexpr std::size_t bdd_memory_limit = std::size_t(1) << 28;
+
+
+// The BDD manager creates and owns BDD nodes.
+//
+// Each node is a variable with a low (false) and a high
+// (true) branch. Edges carry a complement bit, so a
+// function and its negation share nodes, and negation
+// takes constant time. For canonicity, the high edge of a
+// node is never complemented, and there is a single
+// terminal, one. The unique table ensures that no two
+// nodes have the same variable and branches.
+//
+// Every operation is computed by if-then-else (ITE), whose
+// results are recorded in a fixed-size operation cache.
+//
+// Variables are created for atoms in the order they are
+// first seen, which is the order of the diagram. Node
+// memory is bounded by a limit given to the constructor.
+// Nodes that are no longer referenced are reclaimed
+// before an operation when the node count reaches a
+// threshold, or when the operation reaches the limit. An
+// operation that needs more live nodes than the limit
+// allows throws std::length_error.
+class Bdd_manager
+{
+  friend class Bdd;
+public:
+  Bdd_manager(std::size_t = bdd_memory_limit);
+
+  Bdd_manager(Bdd_manager const&) = delete;
+  Bdd_manager& operator=(Bdd_manager const&) = delete;
+
+  // Construction
+  Bdd one();
+  Bdd zero();
+  Bdd var(Symbol const*);
+
+  Bdd make_not(Bdd const&);
+  Bdd make_and(Bdd const&, Bdd const&);
+  Bdd make_or(Bdd const&, Bdd const&);
+  Bdd make_implies(Bdd const&, Bdd const&);
+  Bdd ite(Bdd const&, Bdd const&, Bdd const&);
+
+  Bdd compile(Prop const*);
+
+  // Queries
+  std::size_t count(Bdd const&) const;
+  std::size_t variables() const;
+  std::size_t size() const;
+
+  Bdd_stats const& stats() const;
+
+  void collect();
+
+private:
+  static constexpr std::uint32_t no_node = -1;
+  static constexpr std::uint32_t one_edge = 0;
+  static constexpr std::uint32_t zero_edge = 1;
+
+  // A node. Free nodes are chained through next.
+  struct Node
+  {
+    std::uint32_t var;  // Variable, or no_node for the terminal
+    std::uint32_t low;  // Edge taken when var is false
+    std::uint32_t high; // Edge taken when var is true
+    std::uint32_t next; // Next node in the bucket or free list
+    std::uint32_t refs; // References from BDDs
+  };
+
+  // An entry of the operation cache.
+  struct Entry
+  {
+    std::uint32_t f, g, h;
+    std::uint32_t result;
+  };
+
+  Bdd           wrap(std::uint32_t);
+  void          ref(std::uint32_t);
+  void          unref(std::uint32_t);
+  void          prepare();
+  std::uint32_t run(std::uint32_t, std::uint32_t, std::uint32_t);
+
+  std::uint32_t top(std::uint32_t) const;
+  std::uint32_t low(std::uint32_t, std::uint32_t) const;
+  std::uint32_t high(std::uint32_t, std::uint32_t) const;
+  std::uint32_t make(std::uint32_t, std::uint32_t, std::uint32_t);
+  std::uint32_t ite(std::uint32_t, std::uint32_t, std::uint32_t);
+  void          rehash(std::size_t);
+
+  std::vector<Node>                              nodes_;   // All nodes
+  std::vector<std::uint32_t>                     buckets_; // The unique table
+  std::vector<Entry>                             cache_;   // The operation cache
+  std::unordered_map<Symbol const*, std::uint32_t> vars_;  // Variable of each atom
+  std::uint32_t                                  free_;    // Free list
+  std::size_t                                    live_;    // Allocated nodes
+  std::size_t                                    limit_;   // Most nodes allowed
+  std::size_t                                    next_gc_; // Collect at this size
+  Bdd_stats                                      stats_;
+};
+
+
+inline
+Bdd::Bdd()
+  : mgr_(nullptr), edge_(0)
+{ }
+
+
+inline
+Bdd::Bdd(Bdd_manager* m, std::uint32_t e)
+  : mgr_(m), edge_(e)
+{
+  mgr_->ref(edge_);
+}
+
+
+inline
+Bdd::Bdd(Bdd const& x)
+  : mgr_(x.mgr_), edge_(x.edge_)
+{
+  if (mgr_)
+    mgr_->ref(edge_);
+}
+
+
+inline
+Bdd::~Bdd()
+{
+  if (mgr_)
+    mgr_->unref(edge_);
+}
+
+
+inline Bdd&
+Bdd::operator=(Bdd const& x)
+{
+  if (x.mgr_)
+    x.mgr_->ref(x.edge_);
+  if (mgr_)
+    mgr_->unref(edge_);
+  mgr_ = x.mgr_;
+  edge_ = x.edge_;
+  return *this;
+}
+
+
+// Returns true if the BDD is the constant true.
+inline bool
+Bdd::is_one() const
+{
+  return mgr_ && edge_ == Bdd_manager::one_edge;
+}
+
+
+// Returns true if the BDD is the constant false.
+inline bool
+Bdd::is_zero() const
+{
+  return mgr_ && edge_ == Bdd_manager::zero_edge;
+}
+
+
+// Returns the manager that owns the BDD.
+inline Bdd_manager*
+Bdd::manager() const
+{
+  return mgr_;
+}
+
+
+// Returns true if a and b represent the same function.
+inline bool
+operator==(Bdd const& a, Bdd const& b)
+{
+  return a.mgr_ == b.mgr_ && a.edge_ == b.edge_;
+}
+
+
+inline bool
+operator!=(Bdd const& a, Bdd const& b)
+{
+  return !(a == b);
+}
+
+
+// Returns the number of variables.
+inline std::size_t
+Bdd_manager::variables() const
+{
+  return vars_.size();
+}
+
+
+// Returns the number of allocated nodes, including the
+// terminal.
+inline std::size_t
+Bdd_manager::size() const
+{
+  return live_;
+}
+
+
+// Returns the statistics of the manager.
+inline Bdd_stats const&
+Bdd_manager::stats() const
+{
+  return stats_;
+}
+
+
+// Count a reference to the node of the edge e.
+inline void
+Bdd_manager::ref(std::uint32_t e)
+{
+  ++nodes_[e >> 1].refs;
+}
+
+
+// Release a reference to the node of the edge e.
+inline void
+Bdd_manager::unref(std::uint32_t e)
+{
+  --nodes_[e >> 1].refs;
+}
+
+
+// Returns a BDD for the edge e.
+inline Bdd
+Bdd_manager::wrap(std::uint32_t e)
+{
+  return Bdd(this, e);
+}
+
+
+#endif
@@ -0,0 +1,73 @@
+// Measures the rate of semantic equivalence queries
+// decided by compiling both sides to BDDs, and reports
+// the statistics of the BDD manager.
+//
+// The queries are those of bench-sat. All queries share
+// one manager, so later queries reuse the nodes and cache
+// entries of earlier ones.
+//
+// Usage: bench-bdd [queries] [depth] [atoms] [megabytes]
+
+#include "bdd.hpp"
+#include "ast.hpp"
+#include "gen.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+using namespace std;
+
+
+int
+main(int argc, char* argv[])
+{
+  int queries = argc > 1 ? atoi(argv[1]) : 3000;
+  int depth = argc > 2 ? atoi(argv[2]) : 8;
+  int count = argc > 3 ? atoi(argv[3]) : 16;
+  size_t mb = argc > 4 ? atoi(argv[4]) : 256;
+
+  Symbol_table syms;
+  Prop_factory f;
+  vector<Atom const*> as = make_atoms(syms, f, count);
+
+  // Generate the queries before timing them.
+  minstd_rand r(42);
+  vector<Query> qs = make_queries(f, as, r, queries, depth);
+  size_t nodes = 0;
+  for (Query const& q : qs)
+    nodes += q.first->size() + q.second->size();
+
+  using Clock = chrono::steady_clock;
+  Clock::time_point start = Clock::now();
+  Bdd_manager m(mb << 20);
+  int equal = 0;
+  for (auto const& q : qs) {
+    bool eq = m.compile(q.first) == m.compile(q.second);
+    equal += eq;
+  }
+  Clock::time_point stop = Clock::now();
+  double ms = chrono::duration<double, milli>(stop - start).count();
+
+  // Every normal form must be equivalent.
+  if (equal < equivalent_queries(queries)) {
+    cerr << "error: a rewritten proposition is not equivalent\n";
+    return 1;
+  }
+
+  cout << "queries: " << queries
+       << ", average size " << nodes / (2.0 * queries)
+       << ", equivalent " << equal << '\n';
+  cout << "time: " << ms << " ms, "
+       << 1000 * queries / ms << " queries/s\n";
+
+  Bdd_stats const& s = m.stats();
+  cout << "nodes: " << s.nodes << ", peak " << s.peak
+       << ", collections " << s.collections
+       << ", freed " << s.freed << '\n';
+  cout << "cache: " << s.lookups << " lookups, "
+       << 100.0 * s.hits / s.lookups << "% hits\n";
+}
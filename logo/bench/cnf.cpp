@@ -0,0 +1,77 @@
+
+// Measures the time to encode a large proposition as CNF,
+// for growing sizes, to check that it is linear.
+//
+// Usage: bench-cnf [nodes] [doublings]
+
+#include "cnf.hpp"
+#include "ast.hpp"
+#include "gen.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+using namespace std;
+
+
+// A sink that only counts the literals it receives.
+struct Null_sink : Clause_sink
+{
+  void header(std::uint32_t, std::uint64_t) { }
+  void clause(int const*, std::size_t n) { lits += n; }
+
+  std::size_t lits = 0;
+};
+
+
+// Run fn and return its time in milliseconds.
+template<typename F>
+double
+time(F fn)
+{
+  using Clock = chrono::steady_clock;
+  Clock::time_point start = Clock::now();
+  fn();
+  Clock::time_point stop = Clock::now();
+  return chrono::duration<double, milli>(stop - start).count();
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  size_t nodes = argc > 1 ? atol(argv[1]) : 1 << 20;
+  int doublings = argc > 2 ? atoi(argv[2]) : 3;
+
+  Symbol_table syms;
+  Prop_factory f;
+  vector<Atom const*> as = make_atoms(syms, f, 256);
+
+  for (int i = 0; i <= doublings; ++i, nodes *= 2) {
+    minstd_rand r(42);
+    Prop const* p = make_dag(f, as, r, nodes);
+
+    unique_ptr<Cnf_encoder> e;
+    double t1 = time([&]() { e.reset(new Cnf_encoder(p)); });
+    Null_sink sink;
+    double t2 = time([&]() { e->encode(sink); });
+    ostringstream os;
+    double t3 = time([&]() { Dimacs_writer w(os); e->encode(w); });
+
+    cout << "nodes " << nodes
+         << ": vars " << e->variables()
+         << ", clauses " << e->clauses()
+         << ", number " << t1 << " ms"
+         << ", encode " << t2 << " ms"
+         << ", dimacs " << t3 << " ms ("
+         << os.str().size() / (1 << 20) << " MB), "
+         << 1e6 * (t1 + t3) / nodes << " ns/node\n";
+  }
+}
@@ -0,0 +1,86 @@
+// Measures the evaluation of a proposition over columns
+// of compressed bitmaps, compared with evaluating a
+// compiled program for each row.
+//
+// Atoms have different densities: atom i is true for
+// about one entity in 2^(i mod 12), in runs of random
+// length, so some columns are sparse and others dense.
+//
+// Usage: bench-column [entities] [depth] [atoms]
+
+#include "column.hpp"
+#include "vm.hpp"
+#include "gen.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+using namespace std;
+
+
+int
+main(int argc, char* argv[])
+{
+  uint32_t entities = argc > 1 ? atoi(argv[1]) : 4000000;
+  int depth = argc > 2 ? atoi(argv[2]) : 6;
+  int count = argc > 3 ? atoi(argv[3]) : 16;
+
+  Symbol_table syms;
+  Prop_factory f;
+  vector<Atom const*> atoms = make_atoms(syms, f, count);
+
+  // Fill the columns, and the same values as rows.
+  minstd_rand r(42);
+  Column_store store(entities);
+  vector<uint8_t> rows(size_t(entities) * count);
+  for (int i = 0; i < count; ++i) {
+    Bitmap& col = store.column(atoms[i]->symbol());
+    uint32_t gap = 1u << (i % 12);
+    for (uint32_t e = r() % gap; e < entities; e += 1 + r() % (2 * gap)) {
+      for (uint32_t n = 1 + r() % 4; n && e < entities; --n, ++e) {
+        col.add(e);
+        rows[size_t(e) * count + i] = 1;
+      }
+    }
+  }
+
+  Prop const* p = make_prop(f, atoms, r, depth);
+  Atom_table ids;
+  for (Atom const* a : atoms)
+    ids.get(a->symbol());
+  Program prog = compile(p, ids);
+
+  using Clock = chrono::steady_clock;
+  Clock::time_point start = Clock::now();
+  Bitmap result = select(p, store);
+  Clock::time_point mid = Clock::now();
+  vector<uint8_t> out(entities);
+  prog.run(rows.data(), count, entities, out.data());
+  Clock::time_point stop = Clock::now();
+
+  Bitmap expected;
+  for (uint32_t e = 0; e < entities; ++e) {
+    if (out[e])
+      expected.add(e);
+  }
+  if (result != expected) {
+    cerr << "error: the columns and the rows differ\n";
+    return 1;
+  }
+
+  double col_ms = chrono::duration<double, milli>(mid - start).count();
+  double row_ms = chrono::duration<double, milli>(stop - mid).count();
+  cout << "size: " << p->size() << " nodes, "
+       << entities << " entities, "
+       << result.cardinality() << " selected\n";
+  cout << "columns: " << store.bytes() / 1024 << " KB, rows: "
+       << rows.size() / 1024 << " KB\n";
+  cout << "columns: " << col_ms << " ms, "
+       << 1000 * entities / col_ms << " entities/s\n";
+  cout << "rows: " << row_ms << " ms, "
+       << 1000 * entities / row_ms << " entities/s\n";
+}
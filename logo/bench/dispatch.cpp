@@ -0,0 +1,92 @@
+
+// Compares the cost of dispatching on the kind of a
+// proposition with apply(), which switches on its kind,
+// and with dispatch(), which makes two virtual calls
+// through a visitor.
+//
+// Usage: bench-dispatch [depth] [rounds]
+
+#include "ast.hpp"
+#include "gen.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+using namespace std;
+
+
+// Count the atoms in p, selecting the operation with
+// apply().
+std::size_t
+count_apply(Prop const* p)
+{
+  struct Fn
+  {
+    std::size_t operator()(Atom const*) const { return 1; }
+    std::size_t operator()(Not const* p) const { return count_apply(p->operand()); }
+    std::size_t operator()(And const* p) const { return count_apply(p->left()) + count_apply(p->right()); }
+    std::size_t operator()(Or const* p) const { return count_apply(p->left()) + count_apply(p->right()); }
+    std::size_t operator()(Implies const* p) const { return count_apply(p->left()) + count_apply(p->right()); }
+  };
+  return apply(p, Fn());
+}
+
+
+// Count the atoms in p, selecting the operation with
+// dispatch().
+std::size_t
+count_dispatch(Prop const* p)
+{
+  struct Fn
+  {
+    std::size_t operator()(Atom const*) const { return 1; }
+    std::size_t operator()(Not const* p) const { return count_dispatch(p->operand()); }
+    std::size_t operator()(And const* p) const { return count_dispatch(p->left()) + count_dispatch(p->right()); }
+    std::size_t operator()(Or const* p) const { return count_dispatch(p->left()) + count_dispatch(p->right()); }
+    std::size_t operator()(Implies const* p) const { return count_dispatch(p->left()) + count_dispatch(p->right()); }
+  };
+  return dispatch(p, Fn());
+}
+
+
+// Run count on p for the given number of rounds and
+// report the time per visited node.
+template<typename F>
+void
+run(char const* name, Prop const* p, int rounds, F count)
+{
+  using Clock = chrono::steady_clock;
+  std::size_t n = 0;
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < rounds; ++i)
+    n += count(p);
+  Clock::time_point stop = Clock::now();
+
+  // Each atom is reached through one binary node.
+  double nodes = 2.0 * n - rounds;
+  double ns = chrono::duration<double, nano>(stop - start).count();
+  cout << name << ": " << ns / nodes << " ns/node\n";
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  int depth = argc > 1 ? atoi(argv[1]) : 20;
+  int rounds = argc > 2 ? atoi(argv[2]) : 10;
+
+  Symbol_table syms;
+  Prop_factory f;
+  vector<Atom const*> as = make_atoms(syms, f, 64);
+
+  minstd_rand r(42);
+  Prop const* p = make_and_or(f, as, r, depth);
+  cout << "nodes: " << f.size() << '\n';
+
+  run("apply", p, rounds, count_apply);
+  run("dispatch", p, rounds, count_dispatch);
+}
@@ -0,0 +1,61 @@
+
+// Compares simplification and evaluation of propositions
+// in the pointer representation and the flat one.
+//
+// Usage: bench-flat [depth] [rounds]
+
+#include "flat.hpp"
+#include "simplify.hpp"
+#include "gen.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+using namespace std;
+
+
+// Run fn for the given number of rounds and report the
+// time per round.
+template<typename F>
+void
+run(char const* name, int rounds, F fn)
+{
+  using Clock = chrono::steady_clock;
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < rounds; ++i)
+    fn();
+  Clock::time_point stop = Clock::now();
+  double ms = chrono::duration<double, milli>(stop - start).count();
+  cout << name << ": " << ms / rounds << " ms\n";
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  int depth = argc > 1 ? atoi(argv[1]) : 20;
+  int rounds = argc > 2 ? atoi(argv[2]) : 5;
+
+  Symbol_table syms;
+  Prop_factory f;
+  vector<Atom const*> as = make_atoms(syms, f, 64);
+
+  minstd_rand r(42);
+  Prop const* p = make_and_or(f, as, r, depth);
+  Atom_table atoms;
+  Flat_prop fp = flatten(p, atoms);
+  cout << "nodes: " << fp.size() << '\n';
+
+  vector<bool> v(atoms.size());
+  for (std::size_t i = 0; i < v.size(); ++i)
+    v[i] = r() % 2;
+
+  run("simplify (pointer)", rounds, [&]() { simplify(f, p); });
+  run("simplify (flat)", rounds, [&]() { simplify(fp); });
+  run("evaluate (flat)", rounds, [&]() { evaluate(fp, v); });
+  run("hash (flat)", rounds, [&]() { hash_value(fp, atoms); });
+}
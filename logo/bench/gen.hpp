@@ -0,0 +1,141 @@
+#ifndef BENCH_GEN_HPP
+#define BENCH_GEN_HPP
+
+// Random inputs shared by the benchmarks.
+
+#include "ast.hpp"
+#include "normalize.hpp"
+#include "nnf.hpp"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+// Returns n distinct atoms.
+inline std::vector<Atom const*>
+make_atoms(Symbol_table& syms, Prop_factory& f, int n)
+{
+  std::vector<Atom const*> as;
+  for (int i = 0; i < n; ++i)
+    as.push_back(f.make_atom(syms.put<Symbol>(std::string(1, 'a' + i % 26) + std::to_string(i), 0)));
+  return as;
+}
+
+
+// Build a random proposition of the given depth over
+// the atoms in as.
+inline Prop const*
+make_prop(Prop_factory& f, std::vector<Atom const*> const& as, std::minstd_rand& r, int depth)
+{
+  if (depth == 0)
+    return as[r() % as.size()];
+  Prop const* p1 = make_prop(f, as, r, depth - 1);
+  switch (r() % 5) {
+    case 0: return f.make_not(p1);
+    case 1: return f.make_and(p1, make_prop(f, as, r, depth - 1));
+    case 2: return f.make_or(p1, make_prop(f, as, r, depth - 1));
+    default: return f.make_implies(p1, make_prop(f, as, r, depth - 1));
+  }
+}
+
+
+// Build a random proposition of the given depth over the
+// atoms in as, using only 'and' and 'or'.
+inline Prop const*
+make_and_or(Prop_factory& f, std::vector<Atom const*> const& as, std::minstd_rand& r, int depth)
+{
+  if (depth == 0)
+    return as[r() % as.size()];
+  Prop const* p1 = make_and_or(f, as, r, depth - 1);
+  Prop const* p2 = make_and_or(f, as, r, depth - 1);
+  if (r() % 2)
+    return f.make_and(p1, p2);
+  else
+    return f.make_or(p1, p2);
+}
+
+
+// Build a random proposition with about n distinct nodes
+// over the atoms in as. Each node takes its operands from
+// the nodes built before it, so subpropositions are shared
+// and the tree is far larger than the graph.
+inline Prop const*
+make_dag(Prop_factory& f, std::vector<Atom const*> const& as, std::minstd_rand& r, std::size_t n)
+{
+  std::vector<Prop const*> ps(as.begin(), as.end());
+  while (ps.size() < n) {
+    // Prefer recent nodes, so the last one reaches most.
+    std::size_t k = ps.size();
+    Prop const* p1 = ps[k - 1 - r() % std::min<std::size_t>(k, 64)];
+    Prop const* p2 = ps[r() % k];
+    switch (r() % 4) {
+      case 0: ps.push_back(f.make_and(p1, p2)); break;
+      case 1: ps.push_back(f.make_or(p1, p2)); break;
+      case 2: ps.push_back(f.make_implies(p1, p2)); break;
+      case 3: ps.push_back(f.make_not(p1)); break;
+    }
+  }
+  return ps.back();
+}
+
+
+// Returns p with one of its atoms, chosen by a random
+// path, replaced by a random atom from atoms.
+inline Prop const*
+mutate(Prop_factory& f, std::vector<Atom const*> const& atoms, std::minstd_rand& r, Prop const* p)
+{
+  Path path;
+  for (Prop const* q = p; !is<Atom>(q); ) {
+    if (Not const* n = as<Not>(q)) {
+      path.push_back(0);
+      q = n->operand();
+    } else {
+      Binary const* b = cast<Binary>(q);
+      path.push_back(r() % 2);
+      q = path.back() ? b->right() : b->left();
+    }
+  }
+  return replace(f, p, path, atoms[r() % atoms.size()]);
+}
+
+
+// An equivalence query.
+using Query = std::pair<Prop const*, Prop const*>;
+
+
+// Returns n queries, each comparing a random proposition
+// of the given depth with a rewritten form: its normal
+// form, its negation normal form, or a copy with one atom
+// replaced, in turn. The first two are equivalent, and
+// the last usually is not.
+inline std::vector<Query>
+make_queries(Prop_factory& f, std::vector<Atom const*> const& as, std::minstd_rand& r, int n, int depth)
+{
+  std::vector<Query> qs;
+  for (int i = 0; i < n; ++i) {
+    Prop const* p = make_prop(f, as, r, depth);
+    Prop const* q;
+    switch (i % 3) {
+      case 0: q = normalize(f, p); break;
+      case 1: q = nnf(f, p); break;
+      default: q = mutate(f, as, r, p); break;
+    }
+    qs.emplace_back(p, q);
+  }
+  return qs;
+}
+
+
+// Returns the number of equivalent queries among the
+// first n made by make_queries().
+inline int
+equivalent_queries(int n)
+{
+  return (n + 2) / 3 + (n + 1) / 3;
+}
+
+
+#endif
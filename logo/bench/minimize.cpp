@@ -0,0 +1,92 @@
+// Measures two-level minimization of redundant sums of
+// products, and compares the sizes of the results with
+// those of simplify().
+//
+// Each input is a disjunction of random cubes over a few
+// atoms, many of which overlap or are subsumed. Every
+// result is checked against its input.
+//
+// Usage: bench-minimize [inputs] [cubes] [atoms]
+
+#include "minimize.hpp"
+#include "simplify.hpp"
+#include "truth.hpp"
+#include "ast.hpp"
+#include "gen.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+using namespace std;
+
+
+// Build a disjunction of n random cubes, each with 2 to 5
+// literals over the atoms in atoms.
+Prop const*
+make_sop(Prop_factory& f, vector<Atom const*> const& atoms, minstd_rand& r, int n)
+{
+  Prop const* sum = nullptr;
+  for (int i = 0; i < n; ++i) {
+    Prop const* product = nullptr;
+    for (int k = 2 + r() % 4; k > 0; --k) {
+      Prop const* lit = atoms[r() % atoms.size()];
+      if (r() % 2)
+        lit = f.make_not(lit);
+      product = product ? f.make_and(product, lit) : lit;
+    }
+    sum = sum ? f.make_or(sum, product) : product;
+  }
+  return sum;
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  int inputs = argc > 1 ? atoi(argv[1]) : 200;
+  int cubes = argc > 2 ? atoi(argv[2]) : 40;
+  int count = argc > 3 ? atoi(argv[3]) : 10;
+
+  Symbol_table syms;
+  Prop_factory f;
+  vector<Atom const*> atoms = make_atoms(syms, f, count);
+
+  minstd_rand r(42);
+  vector<Prop const*> ps;
+  for (int i = 0; i < inputs; ++i)
+    ps.push_back(make_sop(f, atoms, r, cubes));
+
+  using Clock = chrono::steady_clock;
+  Clock::time_point start = Clock::now();
+  size_t in = 0, out = 0, simp = 0;
+  vector<Prop const*> results;
+  for (Prop const* p : ps) {
+    in += p->size();
+    results.push_back(minimize(f, p));
+    out += results.back()->size();
+  }
+  Clock::time_point stop = Clock::now();
+
+  // Every result must be equivalent to its input.
+  vector<Symbol const*> ss;
+  for (Atom const* a : atoms)
+    ss.push_back(a->symbol());
+  for (int i = 0; i < inputs; ++i) {
+    if (truth_table(ps[i], ss) != truth_table(results[i], ss)) {
+      cerr << "error: a minimized proposition is not equivalent\n";
+      return 1;
+    }
+  }
+  for (Prop const* p : ps)
+    simp += simplify(f, p)->size();
+  double ms = chrono::duration<double, milli>(stop - start).count();
+
+  cout << "inputs: " << inputs << ", average size " << double(in) / inputs << '\n';
+  cout << "simplify: average size " << double(simp) / inputs << '\n';
+  cout << "minimize: average size " << double(out) / inputs << ", "
+       << ms / inputs << " ms per input\n";
+}
@@ -0,0 +1,72 @@
+// Times normalization of left- and right-nested 'and'
+// chains of increasing length. The time per operand should
+// stay about the same for both, and both chains must have
+// the same normal form. First, absorption by a chain of
+// operands is checked for both operators.
+//
+// Usage: bench-normalize [operands]
+
+#include "normalize.hpp"
+#include "ast.hpp"
+#include "gen.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+
+using namespace std;
+
+
+// Normalize p and report the time taken.
+Prop const*
+run(char const* name, Prop_factory& f, Prop const* p)
+{
+  using Clock = chrono::steady_clock;
+  Clock::time_point start = Clock::now();
+  Prop const* q = normalize(f, p);
+  Clock::time_point stop = Clock::now();
+  double ms = chrono::duration<double, milli>(stop - start).count();
+  cout << "  " << name << ": " << ms << " ms\n";
+  return q;
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  int n = argc > 1 ? atoi(argv[1]) : 80000;
+
+  Symbol_table syms;
+  Prop_factory f;
+  vector<Atom const*> as = make_atoms(syms, f, n);
+
+  // (a and b) and ((a and b) or c) <=> a and b, and
+  // (a or b) or ((a or b) and c) <=> a or b.
+  Prop const* ab = f.make_and(as[0], as[1]);
+  Prop const* a_or_b = f.make_or(as[0], as[1]);
+  Prop const* p1 = f.make_and(ab, f.make_or(ab, as[2]));
+  Prop const* p2 = f.make_or(a_or_b, f.make_and(a_or_b, as[2]));
+  if (normalize(f, p1) != normalize(f, ab) || normalize(f, p2) != normalize(f, a_or_b)) {
+    cerr << "error: an operand is not absorbed\n";
+    return 1;
+  }
+
+  for (int k = n / 4; k <= n; k *= 2) {
+    Prop const* left = as[0];
+    for (int i = 1; i < k; ++i)
+      left = f.make_and(left, as[i]);
+    Prop const* right = as[k - 1];
+    for (int i = k - 1; i-- > 0; )
+      right = f.make_and(as[i], right);
+
+    cout << "operands: " << k << '\n';
+    Prop const* p = run("left-nested", f, left);
+    Prop const* q = run("right-nested", f, right);
+    if (p != q) {
+      cerr << "error: normal forms differ\n";
+      return 1;
+    }
+  }
+}
@@ -0,0 +1,66 @@
+
+// Compares sequential and parallel simplification of a
+// large proposition.
+//
+// Usage: bench-parallel [depth] [rounds]
+
+#include "simplify.hpp"
+#include "ast.hpp"
+#include "pool.hpp"
+#include "gen.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+using namespace std;
+
+
+// Run fn for the given number of rounds and report the
+// time per round.
+template<typename F>
+void
+run(string const& name, int rounds, F fn)
+{
+  using Clock = chrono::steady_clock;
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < rounds; ++i)
+    fn();
+  Clock::time_point stop = Clock::now();
+  double ms = chrono::duration<double, milli>(stop - start).count();
+  cout << name << ": " << ms / rounds << " ms\n";
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  int depth = argc > 1 ? atoi(argv[1]) : 23;
+  int rounds = argc > 2 ? atoi(argv[2]) : 3;
+
+  Symbol_table syms;
+  Prop_factory f(true);
+  vector<Atom const*> as = make_atoms(syms, f, 64);
+
+  minstd_rand r(42);
+  Prop const* p = make_and_or(f, as, r, depth);
+  cout << "nodes: " << p->size() << '\n';
+
+  Prop const* s = simplify(f, p);
+  run("sequential", rounds, [&]() { simplify(f, p); });
+
+  unsigned n = thread::hardware_concurrency();
+  for (unsigned k = 1; k <= n; k *= 2) {
+    Task_pool pool(k);
+    if (simplify(f, p, pool) != s) {
+      cerr << "error: parallel result differs\n";
+      return 1;
+    }
+    run("parallel (" + to_string(k) + " threads)", rounds, [&]() { simplify(f, p, pool); });
+  }
+}
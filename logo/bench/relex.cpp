@@ -0,0 +1,181 @@
+// Checks Lexer::relex() against lexing the edited text
+// from scratch, and compares their times.
+//
+// With no file, random edits are applied to short random
+// inputs that mix identifiers, punctuation, and valid and
+// invalid UTF-8, and every result is checked. Then small
+// edits are applied to a large input, and relex() is timed
+// against lexing the whole buffer again.
+//
+// With a file, the edit given by an offset, a length and
+// optionally the replacement text is applied to its
+// contents, and the result is checked. The regression
+// inputs in test/ are run as:
+//
+//    bench-relex test/relex-utf8-delete.in 2 2
+//    bench-relex test/relex-utf8-join.in 2 0 $'\xb2'
+//
+// Usage: bench-relex [edits]
+//        bench-relex file offset length [text]
+
+#include "lexer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+
+
+using namespace std;
+
+
+// Pieces of random inputs and edits.
+char const* pieces[] = {
+  "a", "n", "o", "r", "and", "or", "not", "->", "-", ">", "(", ")", " ", "\n",
+  "\xce\xb2", "\xce\xb1", "\xce", "\xb2", "\xff", "\xe2\x82", "\xac",
+};
+constexpr int num_pieces = sizeof(pieces) / sizeof(pieces[0]);
+
+
+// Returns a string of up to n random pieces.
+String
+make_text(minstd_rand& r, int n)
+{
+  String s;
+  for (int k = r() % (n + 1); k > 0; --k)
+    s += pieces[r() % num_pieces];
+  return s;
+}
+
+
+// Returns a random edit of the buffer, replacing at most
+// 3 bytes with at most 2 pieces.
+Edit
+make_edit(minstd_rand& r, Stringbuf const& buf)
+{
+  Offset off = r() % (buf.size() + 1);
+  Offset len = min<Offset>(r() % 4, buf.size() - off);
+  return Edit {off, len, make_text(r, 2)};
+}
+
+
+// Returns true if the tokens in ts are those of a full
+// lex of the text in cs.
+bool
+check(Symbol_table& syms, Char_stream const& cs, Token_stream const& ts)
+{
+  Char_stream full(String(cs.buffer().begin(), cs.buffer().end()));
+  Token_stream fts;
+  Diagnostics diags;
+  Lexer lex(syms, full, diags);
+  lex.lex(fts);
+
+  Tokenbuf const& a = ts.buffer();
+  Tokenbuf const& b = fts.buffer();
+  return equal(a.begin(), a.end(), b.begin(), b.end(), [](Token const& x, Token const& y) {
+    return x.kind() == y.kind() && x.symbol() == y.symbol() && x.offset() == y.offset();
+  });
+}
+
+
+// Apply the edit given by args to the contents of the
+// file, and check the result.
+int
+check_file(Symbol_table& syms, int argc, char* argv[])
+{
+  ifstream f(argv[1], ios::binary);
+  if (!f) {
+    cerr << "error: cannot open " << argv[1] << '\n';
+    return 1;
+  }
+  String s {istreambuf_iterator<char>(f), istreambuf_iterator<char>()};
+  Edit e {Offset(stoul(argv[2])), Offset(stoul(argv[3])), argc > 4 ? argv[4] : ""};
+  if (e.offset + e.length > s.size()) {
+    cerr << "error: edit out of range\n";
+    return 1;
+  }
+
+  Char_stream cs(s);
+  Token_stream ts;
+  Diagnostics diags;
+  Lexer lex(syms, cs, diags);
+  lex.lex(ts);
+  lex.relex(ts, e);
+  if (!check(syms, cs, ts)) {
+    cerr << "error: re-lexed tokens differ from a full lex\n";
+    return 1;
+  }
+  cout << "ok\n";
+  return 0;
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  Symbol_table syms;
+  syms.put<Symbol>(String("and"), and_tok);
+  syms.put<Symbol>(String("or"), or_tok);
+  syms.put<Symbol>(String("not"), not_tok);
+
+  if (argc > 3)
+    return check_file(syms, argc, argv);
+  int edits = argc > 1 ? atoi(argv[1]) : 200000;
+
+  // Check sequences of edits to short inputs.
+  minstd_rand r(42);
+  for (int i = 0; i < edits; i += 4) {
+    Char_stream cs(make_text(r, 12));
+    Token_stream ts;
+    Diagnostics diags;
+    Lexer lex(syms, cs, diags);
+    lex.lex(ts);
+    for (int j = 0; j < 4; ++j) {
+      lex.relex(ts, make_edit(r, cs.buffer()));
+      if (!check(syms, cs, ts)) {
+        cerr << "error: re-lexed tokens differ from a full lex\n";
+        return 1;
+      }
+    }
+  }
+  cout << "checked: " << edits << " edits\n";
+
+  // Time edits to a large input.
+  String s;
+  while (s.size() < (1 << 20))
+    s += make_text(r, 12);
+  Char_stream cs(s);
+  Token_stream ts;
+  Diagnostics diags;
+  Lexer lex(syms, cs, diags);
+  lex.lex(ts);
+
+  using Clock = chrono::steady_clock;
+  int rounds = 200;
+  double relex = 0;
+  double full = 0;
+  for (int i = 0; i < rounds; ++i) {
+    Edit e = make_edit(r, cs.buffer());
+    Clock::time_point t0 = Clock::now();
+    lex.relex(ts, e);
+    Clock::time_point t1 = Clock::now();
+
+    Char_stream fcs(String(cs.buffer().begin(), cs.buffer().end()));
+    Token_stream fts;
+    Diagnostics fdiags;
+    Lexer flex(syms, fcs, fdiags);
+    flex.lex(fts);
+    Clock::time_point t2 = Clock::now();
+
+    relex += chrono::duration<double, milli>(t1 - t0).count();
+    full += chrono::duration<double, milli>(t2 - t1).count();
+  }
+  cout << "input: " << cs.buffer().size() << " bytes, "
+       << ts.buffer().size() << " tokens\n";
+  cout << "relex: " << relex / rounds << " ms per edit\n";
+  cout << "full lex: " << full / rounds << " ms per edit\n";
+}
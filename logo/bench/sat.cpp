@@ -0,0 +1,66 @@
+
+// Measures the rate of semantic equivalence queries
+// decided by the SAT solver.
+//
+// Each query compares a random proposition with a
+// rewritten form: its normal form or negation normal form,
+// which are equivalent, or a copy with one atom replaced,
+// which usually is not. The solver is asked directly by
+// is_equivalent_by_sat(), without the truth tables tried
+// first by is_semantically_equivalent().
+//
+// Usage: bench-sat [queries] [depth] [atoms]
+
+#include "equivalent.hpp"
+#include "ast.hpp"
+#include "gen.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+using namespace std;
+
+
+int
+main(int argc, char* argv[])
+{
+  int queries = argc > 1 ? atoi(argv[1]) : 3000;
+  int depth = argc > 2 ? atoi(argv[2]) : 8;
+  int count = argc > 3 ? atoi(argv[3]) : 16;
+
+  Symbol_table syms;
+  Prop_factory f;
+  vector<Atom const*> as = make_atoms(syms, f, count);
+
+  // Generate the queries before timing them.
+  minstd_rand r(42);
+  vector<Query> qs = make_queries(f, as, r, queries, depth);
+  size_t nodes = 0;
+  for (Query const& q : qs)
+    nodes += q.first->size() + q.second->size();
+
+  using Clock = chrono::steady_clock;
+  Clock::time_point start = Clock::now();
+  int equal = 0;
+  for (auto const& q : qs) {
+    equal += is_equivalent_by_sat(f, q.first, q.second);
+  }
+  Clock::time_point stop = Clock::now();
+  double ms = chrono::duration<double, milli>(stop - start).count();
+
+  // Every normal form must be equivalent.
+  if (equal < equivalent_queries(queries)) {
+    cerr << "error: a rewritten proposition is not equivalent\n";
+    return 1;
+  }
+
+  cout << "queries: " << queries
+       << ", average size " << nodes / (2.0 * queries)
+       << ", equivalent " << equal << '\n';
+  cout << "time: " << ms << " ms, "
+       << 1000 * queries / ms << " queries/s\n";
+}
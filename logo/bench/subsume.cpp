@@ -0,0 +1,100 @@
+// Measures forward and backward subsumption queries
+// against an index of random clauses, compared with a
+// linear scan of the clauses.
+//
+// Usage: bench-subsume [clauses] [queries] [atoms]
+
+#include "subsume.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+
+using namespace std;
+
+
+// Returns a random clause of 2 to 8 literals over the
+// given number of atoms.
+Literal_set
+make_clause(minstd_rand& r, uint32_t atoms)
+{
+  Literal_set s;
+  for (int k = 2 + r() % 7; k > 0; --k)
+    s.push_back(2 * (r() % atoms) + r() % 2);
+  sort(s.begin(), s.end());
+  s.erase(unique(s.begin(), s.end()), s.end());
+  return s;
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  int clauses = argc > 1 ? atoi(argv[1]) : 200000;
+  int queries = argc > 2 ? atoi(argv[2]) : 2000;
+  uint32_t atoms = argc > 3 ? atoi(argv[3]) : 200;
+
+  minstd_rand r(42);
+  vector<Literal_set> sets;
+  Subsumption_index index;
+  for (int i = 0; i < clauses; ++i) {
+    sets.push_back(make_clause(r, atoms));
+    index.insert(sets.back());
+  }
+
+  // Queries are random clauses, and copies of stored
+  // clauses with a literal added or removed, so that both
+  // kinds of query have answers.
+  vector<Literal_set> qs;
+  for (int i = 0; i < queries; ++i) {
+    Literal_set q = i % 3 ? sets[r() % sets.size()] : make_clause(r, atoms);
+    if (i % 3 == 1)
+      q.erase(q.begin() + r() % q.size());
+    else if (i % 3 == 2)
+      q.push_back(2 * (r() % atoms)), sort(q.begin(), q.end()), q.erase(unique(q.begin(), q.end()), q.end());
+    qs.push_back(q);
+  }
+
+  using Clock = chrono::steady_clock;
+  Clock::time_point start = Clock::now();
+  size_t found = 0;
+  vector<vector<Subsumption_index::Id>> results;
+  for (Literal_set const& q : qs) {
+    results.push_back(index.subsets(q));
+    results.push_back(index.supersets(q));
+    found += results[results.size() - 2].size() + results.back().size();
+  }
+  Clock::time_point mid = Clock::now();
+  size_t scanned = 0;
+  for (size_t i = 0; i < qs.size(); ++i) {
+    vector<Subsumption_index::Id> sub, super;
+    for (size_t j = 0; j < sets.size(); ++j) {
+      if (includes(qs[i].begin(), qs[i].end(), sets[j].begin(), sets[j].end()))
+        sub.push_back(j);
+      if (includes(sets[j].begin(), sets[j].end(), qs[i].begin(), qs[i].end()))
+        super.push_back(j);
+    }
+    sort(results[2 * i].begin(), results[2 * i].end());
+    sort(results[2 * i + 1].begin(), results[2 * i + 1].end());
+    if (sub != results[2 * i] || super != results[2 * i + 1]) {
+      cerr << "error: the index and the scan differ\n";
+      return 1;
+    }
+    scanned += sub.size() + super.size();
+  }
+  Clock::time_point stop = Clock::now();
+
+  double index_ms = chrono::duration<double, milli>(mid - start).count();
+  double scan_ms = chrono::duration<double, milli>(stop - mid).count();
+  cout << "clauses: " << clauses << ", queries: " << queries
+       << ", found " << found << '\n';
+  cout << "index: " << index_ms << " ms, "
+       << 1000 * queries / index_ms << " queries/s\n";
+  cout << "scan: " << scan_ms << " ms, "
+       << 1000 * queries / scan_ms << " queries/s\n";
+}
@@ -0,0 +1,85 @@
+// Measures the rate of semantic equivalence queries
+// decided by comparing truth tables, and the rate at which
+// table words are computed.
+//
+// The queries are those of bench-sat. Queries over more
+// than 24 atoms have no tables, so they are only passed
+// through the random assignment filter, and are reported
+// as skipped if it does not reject them.
+//
+// Usage: bench-truth [queries] [depth] [atoms]
+
+#include "truth.hpp"
+#include "ast.hpp"
+#include "gen.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+using namespace std;
+
+
+int
+main(int argc, char* argv[])
+{
+  int queries = argc > 1 ? atoi(argv[1]) : 3000;
+  int depth = argc > 2 ? atoi(argv[2]) : 8;
+  int count = argc > 3 ? atoi(argv[3]) : 16;
+
+  Symbol_table syms;
+  Prop_factory f;
+  vector<Atom const*> as = make_atoms(syms, f, count);
+
+  // Generate the queries before timing them.
+  minstd_rand r(42);
+  vector<Query> qs = make_queries(f, as, r, queries, depth);
+  size_t nodes = 0;
+  for (Query const& q : qs)
+    nodes += q.first->size() + q.second->size();
+
+  using Clock = chrono::steady_clock;
+  Clock::time_point start = Clock::now();
+  int equal = 0;
+  int filtered = 0;
+  int skipped = 0;
+  size_t words = 0;
+  for (auto const& q : qs) {
+    Prop const* a = q.first;
+    Prop const* b = q.second;
+    if (!may_be_equivalent(a, b)) {
+      ++filtered;
+      continue;
+    }
+    vector<Symbol const*> syms = support(f.make_and(a, b));
+    if (syms.size() > truth_table_atoms) {
+      ++skipped;
+      continue;
+    }
+    Truth_table t1 = truth_table(a, syms);
+    Truth_table t2 = truth_table(b, syms);
+    equal += t1 == t2;
+    words += t1.words() * (a->size() + b->size());
+  }
+  Clock::time_point stop = Clock::now();
+  double ms = chrono::duration<double, milli>(stop - start).count();
+
+  // Every normal form must be equivalent, unless it was
+  // skipped.
+  if (equal + skipped < equivalent_queries(queries)) {
+    cerr << "error: a rewritten proposition is not equivalent\n";
+    return 1;
+  }
+
+  cout << "queries: " << queries
+       << ", average size " << nodes / (2.0 * queries)
+       << ", equivalent " << equal
+       << ", filtered " << filtered
+       << ", skipped " << skipped << '\n';
+  cout << "time: " << ms << " ms, "
+       << 1000 * queries / ms << " queries/s, "
+       << words / (1000 * ms) << " M words/s (at most)\n";
+}
@@ -0,0 +1,108 @@
+// Measures the rate at which records are evaluated by a
+// compiled program, and by an interpreter that walks the
+// proposition with a visitor.
+//
+// Each record holds a random truth value for each atom.
+// The ids of the atoms are resolved before timing, for
+// both, so the comparison is of the bytecode and its
+// dispatch against the visitor.
+//
+// Usage: bench-vm [records] [depth] [atoms]
+
+#include "vm.hpp"
+#include "gen.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+
+using namespace std;
+
+
+// The id of each atom.
+using Atom_ids = unordered_map<Atom const*, uint32_t>;
+
+
+// Evaluates a proposition for a record by visiting each
+// node, with short-circuit evaluation.
+struct Interpreter : Visitor
+{
+  Interpreter(Atom_ids const& t, uint8_t const* r)
+    : ids(t), record(r)
+  { }
+
+  bool eval(Prop const* p)
+  {
+    p->accept(*this);
+    return value;
+  }
+
+  void visit(Atom const* p) { value = record[ids.find(p)->second]; }
+  void visit(Not const* p) { value = !eval(p->operand()); }
+  void visit(And const* p) { value = eval(p->left()) && eval(p->right()); }
+  void visit(Or const* p) { value = eval(p->left()) || eval(p->right()); }
+  void visit(Implies const* p) { value = !eval(p->left()) || eval(p->right()); }
+
+  Atom_ids const& ids;
+  uint8_t const*  record;
+  bool            value;
+};
+
+
+int
+main(int argc, char* argv[])
+{
+  size_t records = argc > 1 ? atoi(argv[1]) : 1000000;
+  int depth = argc > 2 ? atoi(argv[2]) : 10;
+  int count = argc > 3 ? atoi(argv[3]) : 32;
+
+  Symbol_table syms;
+  Prop_factory f;
+  vector<Atom const*> atoms = make_atoms(syms, f, count);
+
+  minstd_rand r(42);
+  Prop const* p = make_prop(f, atoms, r, depth);
+  Atom_table ids;
+  Atom_ids atom_ids;
+  for (Atom const* a : atoms)
+    atom_ids.emplace(a, ids.get(a->symbol()));
+  Program prog = compile(p, ids);
+
+  vector<uint8_t> data(records * count);
+  for (uint8_t& b : data)
+    b = r() % 2;
+
+  using Clock = chrono::steady_clock;
+  Clock::time_point start = Clock::now();
+  vector<uint8_t> expected(records);
+  for (size_t i = 0; i < records; ++i) {
+    Interpreter interp(atom_ids, &data[i * count]);
+    expected[i] = interp.eval(p);
+  }
+  Clock::time_point mid = Clock::now();
+  vector<uint8_t> out(records);
+  prog.run(data.data(), count, records, out.data());
+  Clock::time_point stop = Clock::now();
+
+  if (out != expected) {
+    cerr << "error: the program and the interpreter differ\n";
+    return 1;
+  }
+
+  double ast_ms = chrono::duration<double, milli>(mid - start).count();
+  double vm_ms = chrono::duration<double, milli>(stop - mid).count();
+  size_t trues = 0;
+  for (uint8_t b : out)
+    trues += b;
+  cout << "size: " << p->size() << " nodes, "
+       << prog.size() << " instructions, "
+       << trues << " of " << records << " records true\n";
+  cout << "interpreter: " << ast_ms << " ms, "
+       << 1000 * records / ast_ms << " records/s\n";
+  cout << "program: " << vm_ms << " ms, "
+       << 1000 * records / vm_ms << " records/s\n";
+}
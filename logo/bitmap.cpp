@@ -0,0 +1,418 @@
+
+#include "bitmap.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+
+constexpr std::uint32_t Bitmap::array_limit;
+
+
+namespace
+{
+
+// The number of words in a bitset container.
+constexpr std::size_t container_words = 65536 / 64;
+
+
+// Returns the number of set bits in the words.
+inline std::uint32_t
+popcount(std::vector<std::uint64_t> const& bits)
+{
+  std::uint32_t n = 0;
+  for (std::uint64_t w : bits)
+    n += __builtin_popcountll(w);
+  return n;
+}
+
+
+// Returns true if the bitset has the value v.
+inline bool
+test(std::vector<std::uint64_t> const& bits, std::uint16_t v)
+{
+  return bits[v / 64] >> (v % 64) & 1;
+}
+
+
+// Returns the position of the first value of a, at or
+// after first, that is not less than v. The search
+// doubles its step from first, then bisects.
+inline std::size_t
+gallop(std::vector<std::uint16_t> const& a, std::size_t first, std::uint16_t v)
+{
+  std::size_t step = 1;
+  std::size_t last = first;
+  while (last < a.size() && a[last] < v) {
+    first = last + 1;
+    last = first + step;
+    step *= 2;
+  }
+  last = std::min(last, a.size());
+  return std::lower_bound(a.begin() + first, a.begin() + last, v) - a.begin();
+}
+
+} // namespace
+
+
+// -------------------------------------------------------------------------- //
+//                                Containers
+
+// Store a container in the form its size requires: an
+// array if it has at most array_limit values, and a bitset
+// otherwise.
+void
+Bitmap::convert(Container& c)
+{
+  if (c.is_array() && c.card > array_limit) {
+    c.bits.assign(container_words, 0);
+    for (std::uint16_t v : c.array)
+      c.bits[v / 64] |= std::uint64_t(1) << (v % 64);
+    c.array.clear();
+    c.array.shrink_to_fit();
+  } else if (!c.is_array() && c.card <= array_limit) {
+    c.array.clear();
+    c.array.reserve(c.card);
+    for (std::size_t i = 0; i < c.bits.size(); ++i) {
+      for (std::uint64_t w = c.bits[i]; w; w &= w - 1)
+        c.array.push_back(i * 64 + __builtin_ctzll(w));
+    }
+    c.bits.clear();
+    c.bits.shrink_to_fit();
+  }
+}
+
+
+// Returns the intersection of two containers with the same
+// key. When one array is much smaller than the other, its
+// values are found in the larger by galloping search.
+Bitmap::Container
+Bitmap::make_and(Container const& a, Container const& b)
+{
+  Container r {a.key, 0, {}, {}};
+  if (a.is_array() && b.is_array()) {
+    std::vector<std::uint16_t> const& x = a.card <= b.card ? a.array : b.array;
+    std::vector<std::uint16_t> const& y = a.card <= b.card ? b.array : a.array;
+    r.array.reserve(x.size());
+    if (64 * x.size() < y.size()) {
+      std::size_t j = 0;
+      for (std::uint16_t v : x) {
+        j = gallop(y, j, v);
+        if (j == y.size())
+          break;
+        if (y[j] == v)
+          r.array.push_back(v);
+      }
+    } else {
+      std::set_intersection(x.begin(), x.end(), y.begin(), y.end(), std::back_inserter(r.array));
+    }
+    r.card = r.array.size();
+  } else if (a.is_array() || b.is_array()) {
+    Container const& x = a.is_array() ? a : b;
+    Container const& y = a.is_array() ? b : a;
+    r.array.reserve(x.card);
+    for (std::uint16_t v : x.array) {
+      if (test(y.bits, v))
+        r.array.push_back(v);
+    }
+    r.card = r.array.size();
+  } else {
+    r.bits.resize(container_words);
+    for (std::size_t i = 0; i < container_words; ++i)
+      r.bits[i] = a.bits[i] & b.bits[i];
+    r.card = popcount(r.bits);
+    convert(r);
+  }
+  return r;
+}
+
+
+// Returns the union of two containers with the same key.
+Bitmap::Container
+Bitmap::make_or(Container const& a, Container const& b)
+{
+  Container r {a.key, 0, {}, {}};
+  if (a.is_array() && b.is_array()) {
+    r.array.reserve(a.card + b.card);
+    std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), std::back_inserter(r.array));
+    r.card = r.array.size();
+    convert(r);
+  } else if (a.is_array() || b.is_array()) {
+    Container const& x = a.is_array() ? a : b;
+    Container const& y = a.is_array() ? b : a;
+    r.bits = y.bits;
+    r.card = y.card;
+    for (std::uint16_t v : x.array) {
+      std::uint64_t m = std::uint64_t(1) << (v % 64);
+      r.card += !(r.bits[v / 64] & m);
+      r.bits[v / 64] |= m;
+    }
+  } else {
+    r.bits.resize(container_words);
+    for (std::size_t i = 0; i < container_words; ++i)
+      r.bits[i] = a.bits[i] | b.bits[i];
+    r.card = popcount(r.bits);
+  }
+  return r;
+}
+
+
+// Returns the values of a that are not in b, where a and b
+// have the same key.
+Bitmap::Container
+Bitmap::make_andnot(Container const& a, Container const& b)
+{
+  Container r {a.key, 0, {}, {}};
+  if (a.is_array()) {
+    r.array.reserve(a.card);
+    if (b.is_array()) {
+      std::set_difference(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), std::back_inserter(r.array));
+    } else {
+      for (std::uint16_t v : a.array) {
+        if (!test(b.bits, v))
+          r.array.push_back(v);
+      }
+    }
+    r.card = r.array.size();
+  } else if (b.is_array()) {
+    r.bits = a.bits;
+    r.card = a.card;
+    for (std::uint16_t v : b.array) {
+      std::uint64_t m = std::uint64_t(1) << (v % 64);
+      r.card -= (r.bits[v / 64] & m) != 0;
+      r.bits[v / 64] &= ~m;
+    }
+    convert(r);
+  } else {
+    r.bits.resize(container_words);
+    for (std::size_t i = 0; i < container_words; ++i)
+      r.bits[i] = a.bits[i] & ~b.bits[i];
+    r.card = popcount(r.bits);
+    convert(r);
+  }
+  return r;
+}
+
+
+// Returns the values less than n that are not in the
+// container a, where n is at most 65536.
+Bitmap::Container
+Bitmap::make_not(Container const& a, std::uint32_t n)
+{
+  Container r {a.key, 0, {}, {}};
+  if (a.is_array()) {
+    r.bits.assign(container_words, 0);
+    for (std::uint32_t v : a.array)
+      r.bits[v / 64] |= std::uint64_t(1) << (v % 64);
+  } else {
+    r.bits = a.bits;
+  }
+  for (std::uint32_t i = 0; i < container_words; ++i) {
+    std::uint32_t lo = 64 * i;
+    if (lo + 64 <= n)
+      r.bits[i] = ~r.bits[i];
+    else if (lo < n)
+      r.bits[i] = ~r.bits[i] & ((std::uint64_t(1) << (n - lo)) - 1);
+    else
+      r.bits[i] = 0;
+  }
+  r.card = popcount(r.bits);
+  convert(r);
+  return r;
+}
+
+
+// -------------------------------------------------------------------------- //
+//                                Bitmaps
+
+// Add the value v to the bitmap.
+void
+Bitmap::add(std::uint32_t v)
+{
+  std::uint16_t key = v >> 16;
+  std::uint16_t low = v & 0xffff;
+  auto iter = std::lower_bound(conts_.begin(), conts_.end(), key, [](Container const& c, std::uint16_t k) {
+    return c.key < k;
+  });
+  if (iter == conts_.end() || iter->key != key)
+    iter = conts_.insert(iter, Container{key, 0, {}, {}});
+
+  Container& c = *iter;
+  if (c.is_array()) {
+    auto pos = std::lower_bound(c.array.begin(), c.array.end(), low);
+    if (pos != c.array.end() && *pos == low)
+      return;
+    c.array.insert(pos, low);
+    ++c.card;
+    convert(c);
+  } else {
+    std::uint64_t m = std::uint64_t(1) << (low % 64);
+    c.card += !(c.bits[low / 64] & m);
+    c.bits[low / 64] |= m;
+  }
+}
+
+
+// Returns true if the bitmap has the value v.
+bool
+Bitmap::contains(std::uint32_t v) const
+{
+  std::uint16_t key = v >> 16;
+  std::uint16_t low = v & 0xffff;
+  auto iter = std::lower_bound(conts_.begin(), conts_.end(), key, [](Container const& c, std::uint16_t k) {
+    return c.key < k;
+  });
+  if (iter == conts_.end() || iter->key != key)
+    return false;
+  if (iter->is_array())
+    return std::binary_search(iter->array.begin(), iter->array.end(), low);
+  return test(iter->bits, low);
+}
+
+
+// Returns the number of values.
+std::uint64_t
+Bitmap::cardinality() const
+{
+  std::uint64_t n = 0;
+  for (Container const& c : conts_)
+    n += c.card;
+  return n;
+}
+
+
+// Returns the number of bytes used by the containers.
+std::size_t
+Bitmap::bytes() const
+{
+  std::size_t n = conts_.size() * sizeof(Container);
+  for (Container const& c : conts_)
+    n += c.array.size() * sizeof(std::uint16_t) + c.bits.size() * sizeof(std::uint64_t);
+  return n;
+}
+
+
+// Returns the values, in increasing order.
+std::vector<std::uint32_t>
+Bitmap::values() const
+{
+  std::vector<std::uint32_t> vs;
+  vs.reserve(cardinality());
+  for (Container const& c : conts_) {
+    std::uint32_t high = std::uint32_t(c.key) << 16;
+    if (c.is_array()) {
+      for (std::uint16_t v : c.array)
+        vs.push_back(high | v);
+    } else {
+      for (std::size_t i = 0; i < c.bits.size(); ++i) {
+        for (std::uint64_t w = c.bits[i]; w; w &= w - 1)
+          vs.push_back(high | (i * 64 + __builtin_ctzll(w)));
+      }
+    }
+  }
+  return vs;
+}
+
+
+// Returns the intersection of a and b. Only the keys of
+// both have containers in the result.
+Bitmap
+operator&(Bitmap const& a, Bitmap const& b)
+{
+  Bitmap r;
+  auto i = a.conts_.begin();
+  auto j = b.conts_.begin();
+  while (i != a.conts_.end() && j != b.conts_.end()) {
+    if (i->key < j->key) {
+      ++i;
+    } else if (j->key < i->key) {
+      ++j;
+    } else {
+      Bitmap::Container c = Bitmap::make_and(*i++, *j++);
+      if (c.card)
+        r.conts_.push_back(std::move(c));
+    }
+  }
+  return r;
+}
+
+
+// Returns the union of a and b.
+Bitmap
+operator|(Bitmap const& a, Bitmap const& b)
+{
+  Bitmap r;
+  auto i = a.conts_.begin();
+  auto j = b.conts_.begin();
+  while (i != a.conts_.end() || j != b.conts_.end()) {
+    if (j == b.conts_.end() || (i != a.conts_.end() && i->key < j->key))
+      r.conts_.push_back(*i++);
+    else if (i == a.conts_.end() || j->key < i->key)
+      r.conts_.push_back(*j++);
+    else
+      r.conts_.push_back(Bitmap::make_or(*i++, *j++));
+  }
+  return r;
+}
+
+
+// Returns the values of a that are not in b.
+Bitmap
+difference(Bitmap const& a, Bitmap const& b)
+{
+  Bitmap r;
+  auto j = b.conts_.begin();
+  for (Bitmap::Container const& c : a.conts_) {
+    while (j != b.conts_.end() && j->key < c.key)
+      ++j;
+    if (j == b.conts_.end() || j->key != c.key) {
+      r.conts_.push_back(c);
+      continue;
+    }
+    Bitmap::Container d = Bitmap::make_andnot(c, *j);
+    if (d.card)
+      r.conts_.push_back(std::move(d));
+  }
+  return r;
+}
+
+
+// Returns the values less than n that are not in a.
+// Unlike the other operations, this visits every chunk
+// below n.
+Bitmap
+complement(Bitmap const& a, std::uint32_t n)
+{
+  Bitmap r;
+  Bitmap::Container none {0, 0, {}, {}};
+  auto i = a.conts_.begin();
+  for (std::uint64_t low = 0; low < n; low += 65536) {
+    std::uint16_t key = low >> 16;
+    std::uint32_t size = std::min<std::uint64_t>(65536, n - low);
+    while (i != a.conts_.end() && i->key < key)
+      ++i;
+    none.key = key;
+    Bitmap::Container const& c = (i != a.conts_.end() && i->key == key) ? *i : none;
+    Bitmap::Container d = Bitmap::make_not(c, size);
+    if (d.card)
+      r.conts_.push_back(std::move(d));
+  }
+  return r;
+}
+
+
+// Returns true if a and b have the same values. Each
+// container has one form for its size, so containers
+// are compared directly.
+bool
+operator==(Bitmap const& a, Bitmap const& b)
+{
+  if (a.conts_.size() != b.conts_.size())
+    return false;
+  for (std::size_t i = 0; i < a.conts_.size(); ++i) {
+    Bitmap::Container const& x = a.conts_[i];
+    Bitmap::Container const& y = b.conts_[i];
+    if (x.key != y.key || x.card != y.card || x.array != y.array || x.bits != y.bits)
+      return false;
+  }
+  return true;
+}
@@ -0,0 +1,82 @@
+#ifndef BITMAP_HPP
+#define BITMAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// -------------------------------------------------------------------------- //
+//                                Bitmaps
+
+// A compressed set of 32-bit integers, in the style of
+// Roaring bitmaps.
+//
+// The integers are partitioned by their high 16 bits into
+// chunks of 65536 values. Each non-empty chunk is stored
+// in a container: a sorted array of its low 16 bits when
+// it has at most 4096 values, and a bitset of 1024 words
+// otherwise. So a container never takes more than 8 KB,
+// and the cost of an operation depends on the sizes of
+// the containers, not on the range of the values.
+class Bitmap
+{
+public:
+  void add(std::uint32_t);
+  bool contains(std::uint32_t) const;
+
+  std::uint64_t              cardinality() const;
+  bool                       empty() const;
+  std::size_t                bytes() const;
+  std::vector<std::uint32_t> values() const;
+
+  friend Bitmap operator&(Bitmap const&, Bitmap const&);
+  friend Bitmap operator|(Bitmap const&, Bitmap const&);
+  friend Bitmap difference(Bitmap const&, Bitmap const&);
+  friend Bitmap complement(Bitmap const&, std::uint32_t);
+
+  friend bool operator==(Bitmap const&, Bitmap const&);
+  friend bool operator!=(Bitmap const&, Bitmap const&);
+
+  // The most values in an array container.
+  static constexpr std::uint32_t array_limit = 4096;
+
+private:
+  // A container of the values whose high bits are key.
+  // If bits is empty, the values are in array.
+  struct Container
+  {
+    bool is_array() const { return bits.empty(); }
+
+    std::uint16_t              key;
+    std::uint32_t              card;  // Number of values
+    std::vector<std::uint16_t> array;
+    std::vector<std::uint64_t> bits;
+  };
+
+  static Container make_and(Container const&, Container const&);
+  static Container make_or(Container const&, Container const&);
+  static Container make_andnot(Container const&, Container const&);
+  static Container make_not(Container const&, std::uint32_t);
+  static void      convert(Container&);
+
+  std::vector<Container> conts_; // Containers, by key
+};
+
+
+// Returns true if the bitmap has no values.
+inline bool
+Bitmap::empty() const
+{
+  return conts_.empty();
+}
+
+
+inline bool
+operator!=(Bitmap const& a, Bitmap const& b)
+{
+  return !(a == b);
+}
+
+
+#endif
@@ -5,30 +5,45 @@
 #include <cassert>
 
 
+// The casting operations query the dynamic type of an
+// object through a kind discriminator rather than by RTTI.
+// The target class U must provide a static member function
+// classof(T const*) that returns true when its argument is
+// a U. Typically, this compares the kind of the object:
+//
+//    struct Derived : Base
+//    {
+//      static bool classof(Base const* p) { return p->kind() == derived_kind; }
+//    };
+
+
+// Returns true if t is a (non-null) U.
 template<typename U, typename T>
-inline U*
-as(T* t)
+inline bool
+is(T const* t)
 {
-  return dynamic_cast<U*>(t);
+  return t && U::classof(t);
 }
 
 
+// Returns t as a U, or nullptr if it is not a U.
 template<typename U, typename T>
-inline U const*
-as(T const* t)
+inline U*
+as(T* t)
 {
-  return dynamic_cast<U const*>(t);
+  return is<U>(t) ? static_cast<U*>(t) : nullptr;
 }
 
 
 template<typename U, typename T>
-inline bool
-is(T const* t)
+inline U const*
+as(T const* t)
 {
-  return dynamic_cast<U const*>(t);
+  return is<U>(t) ? static_cast<U const*>(t) : nullptr;
 }
 
 
+// Returns t as a U. Behavior is undefined if t is not a U.
 template<typename U, typename T>
 inline U*
 cast(T* t)
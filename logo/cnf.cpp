@@ -0,0 +1,258 @@
+
+#include "cnf.hpp"
+#include "ast.hpp"
+
+#include <climits>
+#include <ostream>
+#include <stdexcept>
+
+
+// -------------------------------------------------------------------------- //
+//                              DIMACS output
+
+namespace
+{
+
+constexpr std::size_t dimacs_buffer = 64 * 1024;
+
+} // namespace
+
+
+Dimacs_writer::Dimacs_writer(std::ostream& os)
+  : os_(os)
+{
+  buf_.reserve(dimacs_buffer + 256);
+}
+
+
+Dimacs_writer::~Dimacs_writer()
+{
+  flush();
+}
+
+
+// Write the problem line.
+void
+Dimacs_writer::header(std::uint32_t vars, std::uint64_t clauses)
+{
+  buf_ += "p cnf ";
+  put(vars);
+  buf_ += ' ';
+  put(clauses);
+  buf_ += '\n';
+}
+
+
+// Write a clause, terminated by 0.
+void
+Dimacs_writer::clause(int const* lits, std::size_t n)
+{
+  for (std::size_t i = 0; i < n; ++i) {
+    put(lits[i]);
+    buf_ += ' ';
+  }
+  buf_ += "0\n";
+  if (buf_.size() >= dimacs_buffer)
+    flush();
+}
+
+
+// Write the buffered output to the stream.
+void
+Dimacs_writer::flush()
+{
+  os_.write(buf_.data(), buf_.size());
+  buf_.clear();
+}
+
+
+// Append the decimal digits of n to the buffer.
+void
+Dimacs_writer::put(std::int64_t n)
+{
+  char tmp[24];
+  char* p = tmp + sizeof(tmp);
+  std::uint64_t u = n < 0 ? -std::uint64_t(n) : n;
+  do {
+    *--p = '0' + u % 10;
+    u /= 10;
+  } while (u);
+  if (n < 0)
+    *--p = '-';
+  buf_.append(p, tmp + sizeof(tmp));
+}
+
+
+// -------------------------------------------------------------------------- //
+//                              CNF encoding
+
+// Number the distinct nodes of p and assign their literals,
+// then compute the polarity of each node and count the
+// clauses needed to define it.
+//
+// Nodes are numbered in post-order from an explicit stack,
+// so operands precede their uses and p is the last node.
+// Polarities are then propagated from uses to operands in
+// one backward scan. The positions of operands are
+// recorded, so neither that scan nor encode() looks up
+// nodes by address.
+Cnf_encoder::Cnf_encoder(Prop const* p)
+  : syms_(1, nullptr), count_(0)
+{
+  auto new_var = [this](Symbol const* s) {
+    if (syms_.size() > std::size_t(INT_MAX))
+      throw std::length_error("too many variables");
+    syms_.push_back(s);
+    return int(syms_.size() - 1);
+  };
+
+  index_.reserve(p->size() < (1u << 20) ? p->size() : (1u << 20));
+  std::vector<Prop const*> work {p};
+  while (!work.empty()) {
+    Prop const* q = work.back();
+    if (index_.count(q)) {
+      work.pop_back();
+      continue;
+    }
+
+    // Visit the operands of a node before the node itself.
+    std::size_t n = work.size();
+    if (Not const* r = as<Not>(q)) {
+      if (!index_.count(r->operand()))
+        work.push_back(r->operand());
+    } else if (Binary const* r = as<Binary>(q)) {
+      if (!index_.count(r->right()))
+        work.push_back(r->right());
+      if (!index_.count(r->left()))
+        work.push_back(r->left());
+    }
+    if (work.size() != n)
+      continue;
+    work.pop_back();
+
+    std::uint32_t l = 0, r = 0;
+    int lit;
+    if (Atom const* a = as<Atom>(q)) {
+      lit = new_var(a->symbol());
+    } else if (Not const* n = as<Not>(q)) {
+      l = index_[n->operand()];
+      lit = -lits_[l];
+    } else {
+      Binary const* b = cast<Binary>(q);
+      l = index_[b->left()];
+      r = index_[b->right()];
+      lit = new_var(nullptr);
+    }
+    index_.emplace(q, nodes_.size());
+    nodes_.push_back(q);
+    left_.push_back(l);
+    right_.push_back(r);
+    lits_.push_back(lit);
+  }
+
+  // The root occurs positively, and is asserted by a unit
+  // clause. Negation and the left operand of an implication
+  // flip the polarity of their operands.
+  auto flip = [](std::uint8_t pol) -> std::uint8_t {
+    return (pol & positive ? negative : 0) | (pol & negative ? positive : 0);
+  };
+  pols_.assign(nodes_.size(), 0);
+  pols_.back() = positive;
+  count_ = 1;
+  for (std::size_t i = nodes_.size(); i-- > 0; ) {
+    Prop const* q = nodes_[i];
+    std::uint8_t pol = pols_[i];
+    if (is<Not>(q)) {
+      pols_[left_[i]] |= flip(pol);
+    } else if (is<Binary>(q)) {
+      pols_[left_[i]] |= is<Implies>(q) ? flip(pol) : pol;
+      pols_[right_[i]] |= pol;
+
+      // A conjunction needs two clauses for its positive
+      // definition and one for its negative definition. The
+      // others are disjunctions, and need the reverse.
+      bool conj = is<And>(q);
+      if (pol & positive)
+        count_ += conj ? 2 : 1;
+      if (pol & negative)
+        count_ += conj ? 1 : 2;
+    }
+  }
+}
+
+
+// Returns the literal of the subproposition q of the
+// encoded proposition.
+int
+Cnf_encoder::literal(Prop const* q) const
+{
+  return lits_[index_.at(q)];
+}
+
+
+// Deliver the header and clauses of the encoding to the
+// sink. For each auxiliary variable g, where a and b are
+// the literals of the operands, the definitions are:
+//
+//    g <=> a and b   positive: (-g a) (-g b)   negative: (g -a -b)
+//    g <=> a or b    positive: (-g a b)        negative: (g -a) (g -b)
+//    g <=> a -> b    as g <=> -a or b
+//
+// Finally, the literal of the root is asserted.
+void
+Cnf_encoder::encode(Clause_sink& sink) const
+{
+  sink.header(variables(), count_);
+  for (std::size_t i = 0; i < nodes_.size(); ++i) {
+    Prop const* b = nodes_[i];
+    if (!is<Binary>(b))
+      continue;
+    int g = lits_[i];
+    int x = lits_[left_[i]];
+    int y = lits_[right_[i]];
+    std::uint8_t pol = pols_[i];
+    if (is<And>(b)) {
+      if (pol & positive) {
+        int c1[] = {-g, x};
+        int c2[] = {-g, y};
+        sink.clause(c1, 2);
+        sink.clause(c2, 2);
+      }
+      if (pol & negative) {
+        int c[] = {g, -x, -y};
+        sink.clause(c, 3);
+      }
+    } else {
+      if (is<Implies>(b))
+        x = -x;
+      if (pol & positive) {
+        int c[] = {-g, x, y};
+        sink.clause(c, 3);
+      }
+      if (pol & negative) {
+        int c1[] = {g, -x};
+        int c2[] = {g, -y};
+        sink.clause(c1, 2);
+        sink.clause(c2, 2);
+      }
+    }
+  }
+
+  int root = lits_.back();
+  sink.clause(&root, 1);
+}
+
+
+// Write the CNF encoding of p to os in the DIMACS format.
+// Each atom is named by a comment line before the header.
+void
+write_dimacs(std::ostream& os, Prop const* p)
+{
+  Cnf_encoder e(p);
+  for (std::uint32_t v = 1; v <= e.variables(); ++v) {
+    if (Symbol const* s = e.symbol(v))
+      os << "c " << v << ' ' << s->spelling() << '\n';
+  }
+  Dimacs_writer w(os);
+  e.encode(w);
+}
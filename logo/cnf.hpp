@@ -0,0 +1,135 @@
+#ifndef CNF_HPP
+#define CNF_HPP
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+struct Prop;
+class Symbol;
+
+
+// -------------------------------------------------------------------------- //
+//                              Clause sinks
+
+// A clause sink receives the clauses of an encoding. A
+// literal is a nonzero integer: the variable v is the
+// literal v, and its negation is -v, as in DIMACS.
+//
+// The header is delivered once, before any clause, with
+// the number of variables and clauses that follow.
+class Clause_sink
+{
+public:
+  virtual ~Clause_sink() { }
+
+  virtual void header(std::uint32_t vars, std::uint64_t clauses) = 0;
+  virtual void clause(int const* lits, std::size_t n) = 0;
+};
+
+
+// Writes clauses to a stream in the DIMACS CNF format.
+// Output is formatted into a buffer, which is written to
+// the stream whenever it fills and when the writer is
+// destroyed.
+class Dimacs_writer : public Clause_sink
+{
+public:
+  Dimacs_writer(std::ostream&);
+  ~Dimacs_writer();
+
+  void header(std::uint32_t, std::uint64_t);
+  void clause(int const*, std::size_t);
+
+  void flush();
+
+private:
+  void put(std::int64_t);
+
+  std::ostream& os_;
+  std::string   buf_;
+};
+
+
+// -------------------------------------------------------------------------- //
+//                              CNF encoding
+
+// The CNF encoder produces an equisatisfiable set of
+// clauses for a proposition, using the Plaisted-Greenbaum
+// refinement of the Tseitin encoding.
+//
+// Each atom is a variable, and each distinct conjunction,
+// disjunction or implication is an auxiliary variable
+// defined by clauses over the literals of its operands.
+// A negation is the negated literal of its operand, and
+// needs no variable. Shared subpropositions are defined
+// once. Only the direction of each definition required by
+// the polarity of its occurrences is emitted, so a node
+// occurring only positively (under an even number of
+// negations) gets the clauses for g -> f(a, b), and one
+// occurring only negatively gets those for f(a, b) -> g.
+//
+// Encoding takes two linear passes. Construction numbers
+// the nodes, computes their polarities, and counts the
+// variables and clauses. Then encode() delivers the header
+// and clauses to a sink, so the output can be streamed.
+class Cnf_encoder
+{
+public:
+  Cnf_encoder(Prop const*);
+
+  std::uint32_t variables() const;
+  std::uint64_t clauses() const;
+
+  int           literal(Prop const*) const;
+  Symbol const* symbol(int) const;
+
+  void encode(Clause_sink&) const;
+
+private:
+  // Polarities of occurrences.
+  enum : std::uint8_t { positive = 1, negative = 2 };
+
+  std::vector<Prop const*>                       nodes_; // Operands before uses
+  std::vector<std::uint32_t>                     left_;  // Position of the left operand
+  std::vector<std::uint32_t>                     right_; // Position of the right operand
+  std::vector<int>                               lits_;  // Literal of each node
+  std::vector<std::uint8_t>                      pols_;  // Polarity of each node
+  std::unordered_map<Prop const*, std::uint32_t> index_; // Node to position
+  std::vector<Symbol const*>                     syms_;  // Atom of each variable
+  std::uint64_t                                  count_; // Number of clauses
+};
+
+
+// Returns the number of variables of the encoding.
+inline std::uint32_t
+Cnf_encoder::variables() const
+{
+  return syms_.size() - 1;
+}
+
+
+// Returns the number of clauses of the encoding.
+inline std::uint64_t
+Cnf_encoder::clauses() const
+{
+  return count_;
+}
+
+
+// Returns the atom of the variable v, or nullptr if v is
+// an auxiliary variable.
+inline Symbol const*
+Cnf_encoder::symbol(int v) const
+{
+  return syms_[v < 0 ? -v : v];
+}
+
+
+void write_dimacs(std::ostream&, Prop const*);
+
+
+#endif
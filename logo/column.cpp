@@ -0,0 +1,142 @@
+
+#include "column.hpp"
+#include "ast.hpp"
+
+#include <unordered_map>
+#include <utility>
+
+
+// Returns the number of bytes used by the columns.
+std::size_t
+Column_store::bytes() const
+{
+  std::size_t n = 0;
+  for (auto const& x : columns_)
+    n += x.second.bytes();
+  return n;
+}
+
+
+// Returns the set of entities in the store for which p is
+// true.
+//
+// Each distinct node of p is evaluated once, in post-order,
+// to a set and a sign: a negative node is true for the
+// entities that are not in its set. So negation flips the
+// sign, and each connective is one intersection, union or
+// difference of the sets of its operands. Where a and b
+// are the sets of the operands, and -a is a negative node:
+//
+//    a and b    a & b            a or b     a | b
+//    a and -b   a - b            a or -b    -(b - a)
+//    -a and b   b - a            -a or b    -(a - b)
+//    -a and -b  -(a | b)         -a or -b   -(a & b)
+//
+// An implication is the disjunction of its negated left
+// operand and its right operand. So the cost depends on
+// the sizes of the columns, not on the number of
+// entities; only a negative result is complemented over
+// all entities.
+//
+// The set of a node is released after its last use.
+Bitmap
+select(Prop const* p, Column_store const& store)
+{
+  struct Value
+  {
+    Bitmap set;
+    bool   neg;
+  };
+
+  std::unordered_map<Prop const*, std::uint32_t> index;
+  std::vector<Value> values;
+  std::vector<std::uint32_t> uses;
+  std::vector<Prop const*> nodes;
+  std::vector<Prop const*> work {p};
+  while (!work.empty()) {
+    Prop const* q = work.back();
+    if (index.count(q)) {
+      work.pop_back();
+      continue;
+    }
+
+    // Number the operands of a node before the node.
+    std::size_t n = work.size();
+    if (Not const* r = as<Not>(q)) {
+      if (!index.count(r->operand()))
+        work.push_back(r->operand());
+    } else if (Binary const* r = as<Binary>(q)) {
+      if (!index.count(r->right()))
+        work.push_back(r->right());
+      if (!index.count(r->left()))
+        work.push_back(r->left());
+    }
+    if (work.size() != n)
+      continue;
+    work.pop_back();
+
+    if (Not const* r = as<Not>(q)) {
+      ++uses[index[r->operand()]];
+    } else if (Binary const* r = as<Binary>(q)) {
+      ++uses[index[r->left()]];
+      ++uses[index[r->right()]];
+    }
+    index.emplace(q, nodes.size());
+    nodes.push_back(q);
+    uses.push_back(0);
+  }
+
+  values.resize(nodes.size());
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    Prop const* q = nodes[i];
+    Value& v = values[i];
+    if (Atom const* a = as<Atom>(q)) {
+      if (Bitmap const* c = store.find(a->symbol()))
+        v.set = *c;
+      v.neg = false;
+      continue;
+    }
+
+    // Take the values of the operands, moving from those
+    // that are not used again.
+    auto get = [&](Prop const* x) {
+      std::uint32_t j = index[x];
+      if (--uses[j] == 0)
+        return std::move(values[j]);
+      return values[j];
+    };
+    if (Not const* r = as<Not>(q)) {
+      v = get(r->operand());
+      v.neg = !v.neg;
+      continue;
+    }
+
+    Binary const* b = cast<Binary>(q);
+    Value x = get(b->left());
+    Value y = get(b->right());
+    bool conj = is<And>(q);
+    if (is<Implies>(q))
+      x.neg = !x.neg;
+
+    // A disjunction is the negated conjunction of the
+    // negated operands.
+    if (!conj) {
+      x.neg = !x.neg;
+      y.neg = !y.neg;
+    }
+    if (!x.neg && !y.neg)
+      v.set = x.set & y.set;
+    else if (!x.neg)
+      v.set = difference(x.set, y.set);
+    else if (!y.neg)
+      v.set = difference(y.set, x.set);
+    else
+      v.set = x.set | y.set;
+    v.neg = (x.neg && y.neg) == conj;
+  }
+
+  Value& r = values.back();
+  if (r.neg)
+    return complement(r.set, store.entities());
+  return std::move(r.set);
+}
@@ -0,0 +1,76 @@
+#ifndef COLUMN_HPP
+#define COLUMN_HPP
+
+#include "bitmap.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+
+
+struct Prop;
+class Symbol;
+
+
+// -------------------------------------------------------------------------- //
+//                              Column stores
+
+// A column store holds the truth values of atoms for a
+// set of entities, numbered from 0. The column of an atom
+// is the set of entities for which it is true, stored as
+// a compressed bitmap. An atom without a column is false
+// for every entity.
+class Column_store
+{
+public:
+  Column_store(std::uint32_t);
+
+  std::uint32_t entities() const;
+  std::size_t   bytes() const;
+
+  Bitmap&       column(Symbol const*);
+  Bitmap const* find(Symbol const*) const;
+
+private:
+  std::uint32_t                             entities_;
+  std::unordered_map<Symbol const*, Bitmap> columns_;
+};
+
+
+// Construct a store of n entities.
+inline
+Column_store::Column_store(std::uint32_t n)
+  : entities_(n)
+{ }
+
+
+// Returns the number of entities.
+inline std::uint32_t
+Column_store::entities() const
+{
+  return entities_;
+}
+
+
+// Returns the column of the atom s, which is created if
+// the atom has none.
+inline Bitmap&
+Column_store::column(Symbol const* s)
+{
+  return columns_[s];
+}
+
+
+// Returns the column of the atom s, or nullptr if it has
+// none.
+inline Bitmap const*
+Column_store::find(Symbol const* s) const
+{
+  auto iter = columns_.find(s);
+  return iter != columns_.end() ? &iter->second : nullptr;
+}
+
+
+Bitmap select(Prop const*, Column_store const&);
+
+
+#endif
@@ -0,0 +1,84 @@
+
+#include "diagnostics.hpp"
+#include "location.hpp"
+#include "unicode.hpp"
+
+#include <iostream>
+#include <sstream>
+
+
+namespace
+{
+
+// Returns a description of the diagnostic code.
+char const*
+message(Diagnostic_code c)
+{
+  switch (c) {
+    case invalid_character_diag: return "invalid character";
+    case invalid_encoding_diag: return "invalid UTF-8 byte";
+  }
+  return "unknown error";
+}
+
+
+// Write the byte c, escaping it if it is not printable.
+void
+print_char(std::ostream& os, char c)
+{
+  unsigned char u = c;
+  if (0x20 <= u && u < 0x7f) {
+    os << c;
+  } else {
+    static char const digits[] = "0123456789abcdef";
+    os << "\\x" << digits[u >> 4] << digits[u & 0xf];
+  }
+}
+
+} // namespace
+
+
+// Write all recorded diagnostics to the output stream
+// and reset the sink. The source buffer is used to
+// show the offending text and to compute the line and
+// column of each diagnostic.
+//
+// The output is formatted into a single string so that
+// it reaches the stream in one write.
+void
+Diagnostics::flush(std::ostream& os, Stringbuf const& buf)
+{
+  if (empty())
+    return;
+
+  Line_map lines(buf);
+  std::ostringstream ss;
+  for (Diagnostic const& d : diags_) {
+    Location loc = lines.resolve(d.offset);
+    ss << loc.line << ':' << loc.column << ": ";
+    ss << "error: " << message(d.code);
+    char const* p = buf.begin() + d.offset;
+    char32_t c;
+    if (d.length == 1) {
+      ss << " '";
+      print_char(ss, *p);
+      ss << "'";
+    } else if (d.code == invalid_character_diag && decode_utf8(p, p + d.length, c) == int(d.length)) {
+      ss << " '";
+      ss.write(p, d.length);
+      ss << "'";
+    } else {
+      ss << "s (" << d.length << " bytes)";
+    }
+    ss << '\n';
+  }
+  if (suppressed_)
+    ss << "note: " << suppressed_ << " more errors were suppressed\n";
+
+  String s = ss.str();
+  os.write(s.data(), s.size());
+  os.flush();
+
+  diags_.clear();
+  suppressed_ = 0;
+}
@@ -1,61 +1,118 @@
 
 #include "equivalent.hpp"
 #include "ast.hpp"
+#include "cnf.hpp"
+#include "sat.hpp"
+#include "truth.hpp"
 
+#include <utility>
+#include <vector>
 
-bool
-is_equivalent(Atom const* a, Atom const* b)
+
+namespace
 {
-  return a->symbol() == b->symbol();
-}
+
+// The most word operations spent comparing truth tables
+// for semantic equivalence.
+constexpr std::uint64_t truth_table_budget = 1 << 18;
+
+} // namespace
 
 
+// Returns true if a and b have the same structure. Unlike
+// is_equivalent(), this can compare propositions created
+// by different factories. Propositions with different
+// hashes are rejected without visiting their operands.
+//
+// Pairs of operands that remain to be compared are kept
+// on an explicit stack, so a and b may be arbitrarily
+// deep.
 bool
-is_equivalent(And const* a, And const* b)
+is_structurally_equal(Prop const* a, Prop const* b)
 {
-  return is_equivalent(a->first, b->first)
-      && is_equivalent(a->second, b->second);
+  std::vector<std::pair<Prop const*, Prop const*>> work {{a, b}};
+  while (!work.empty()) {
+    Prop const* p = work.back().first;
+    Prop const* q = work.back().second;
+    work.pop_back();
+    if (p == q)
+      continue;
+    if (p->hash() != q->hash() || p->kind() != q->kind())
+      return false;
+    if (Atom const* p1 = as<Atom>(p)) {
+      if (p1->symbol() != cast<Atom>(q)->symbol())
+        return false;
+      continue;
+    }
+    if (Not const* p1 = as<Not>(p)) {
+      work.emplace_back(p1->operand(), cast<Not>(q)->operand());
+      continue;
+    }
+    Binary const* p1 = cast<Binary>(p);
+    Binary const* q1 = cast<Binary>(q);
+    work.emplace_back(p1->right(), q1->right());
+    work.emplace_back(p1->left(), q1->left());
+  }
+  return true;
 }
 
 
-// TODO: Make this generic.
+// Returns true if some assignment to the atoms of p makes
+// it true. This is decided by the SAT solver, from the CNF
+// encoding of p.
 bool
-is_equivalent(Or const* a, Or const* b)
+is_satisfiable(Prop const* p)
 {
-  return is_equivalent(a->first, b->first)
-      && is_equivalent(a->second, b->second);
+  Cnf_encoder e(p);
+  Sat_solver s;
+  e.encode(s);
+  return s.solve();
 }
 
 
+// Returns true if every assignment to the atoms of p makes
+// it true, which is when its negation is unsatisfiable.
+// The negation is created by the factory f.
 bool
-is_equivalent(Prop const* a, Prop const* b)
+is_valid(Prop_factory& f, Prop const* p)
 {
-  if (typeid(*a) != typeid(*b))
-    return false;
+  return !is_satisfiable(f.make_not(p));
+}
 
-  struct Fn
-  {
-    Fn(Prop const* b)
-      : b(b)
-    { }
 
-    bool operator()(Atom const* a) const 
-    { 
-      return is_equivalent(a, cast<Atom>(b)); 
-    }
+// Returns true if a and b have the same value under every
+// assignment to their atoms, as decided by the SAT solver
+// alone. Both must be created by the factory f.
+bool
+is_equivalent_by_sat(Prop_factory& f, Prop const* a, Prop const* b)
+{
+  if (a == b)
+    return true;
+  return is_valid(f, f.make_and(f.make_implies(a, b), f.make_implies(b, a)));
+}
 
-    bool operator()(And const* a) const 
-    { 
-      return is_equivalent(a, cast<And>(b)); 
-    }
 
-    bool operator()(Or const* a) const 
-    { 
-      return is_equivalent(a, cast<Or>(b)); 
-    }
-    
-    Prop const* b;
-  };
+// Returns true if a and b have the same value under every
+// assignment to their atoms. Unlike is_equivalent(), this
+// does not depend on their structure. Both must be created
+// by the factory f, so that equal atoms are the same node.
+//
+// Propositions over few atoms are compared by their truth
+// tables. Otherwise, random assignments may show that they
+// differ before the SAT solver is asked.
+bool
+is_semantically_equivalent(Prop_factory& f, Prop const* a, Prop const* b)
+{
+  if (a == b)
+    return true;
 
-  return apply(a, Fn{b});
+  std::vector<Symbol const*> syms = support(f.make_and(a, b));
+  if (syms.size() <= truth_table_atoms) {
+    std::uint64_t words = syms.size() < 6 ? 1 : std::uint64_t(1) << (syms.size() - 6);
+    if (words * (a->size() + b->size()) <= truth_table_budget)
+      return truth_table(a, syms) == truth_table(b, syms);
+  }
+  if (!may_be_equivalent(a, b))
+    return false;
+  return is_equivalent_by_sat(f, a, b);
 }
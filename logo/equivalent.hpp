@@ -4,9 +4,27 @@
 
 
 struct Prop;
+class Prop_factory;
 
 
-bool is_equivalent(Prop const*, Prop const*);
+// Returns true if a and b are equivalent. Propositions
+// created by the same factory are unique, so this is an
+// identity comparison.
+inline bool
+is_equivalent(Prop const* a, Prop const* b)
+{
+  return a == b;
+}
+
+
+bool is_structurally_equal(Prop const*, Prop const*);
+
+
+// Semantic queries
+bool is_satisfiable(Prop const*);
+bool is_valid(Prop_factory&, Prop const*);
+bool is_equivalent_by_sat(Prop_factory&, Prop const*, Prop const*);
+bool is_semantically_equivalent(Prop_factory&, Prop const*, Prop const*);
 
 
 #endif
@@ -0,0 +1,442 @@
+
+#include "flat.hpp"
+#include "hash.hpp"
+
+#include <stdexcept>
+
+
+constexpr std::uint32_t Flat_prop::no_index;
+
+
+// -------------------------------------------------------------------------- //
+//                              Atom table
+
+// Returns the id of the symbol s, assigning a new id
+// if s has not been seen before.
+std::uint32_t
+Atom_table::get(Symbol const* s)
+{
+  auto iter = ids_.find(s);
+  if (iter != ids_.end())
+    return iter->second;
+  if (syms_.size() >= Flat_prop::no_index)
+    throw std::length_error("too many atoms");
+  std::uint32_t n = syms_.size();
+  ids_.emplace(s, n);
+  syms_.push_back(s);
+  return n;
+}
+
+
+// -------------------------------------------------------------------------- //
+//                              Flat builder
+
+namespace
+{
+
+// The flat builder appends nodes to a flat proposition.
+// Nodes are hash-consed, so an existing node is returned
+// when one with the same kind and operands (or atom) is
+// requested, and two nodes built by the same builder are
+// structurally equal if and only if they have the same
+// index.
+class Flat_builder
+{
+public:
+  Flat_builder();
+
+  Prop_kind     kind(std::uint32_t n) const  { return prop_.kind[n]; }
+  std::uint32_t left(std::uint32_t n) const  { return prop_.left[n]; }
+  std::uint32_t right(std::uint32_t n) const { return prop_.right[n]; }
+
+  std::uint32_t make_atom(std::uint32_t);
+  std::uint32_t make_not(std::uint32_t);
+  std::uint32_t make_binary(Prop_kind, std::uint32_t, std::uint32_t);
+
+  std::uint32_t add(Flat_prop const&);
+
+  Flat_prop take(std::uint32_t);
+
+private:
+  std::uint32_t make(Prop_kind, std::uint32_t, std::uint32_t, std::uint32_t);
+  void          rehash();
+
+  Flat_prop                  prop_;  // Nodes built
+  std::vector<std::uint32_t> table_; // Open-addressed node indexes
+};
+
+
+// Returns a hash of the node with the given fields.
+inline std::size_t
+hash_node(Prop_kind k, std::uint32_t l, std::uint32_t r, std::uint32_t a)
+{
+  std::uint64_t x = std::uint64_t(l) << 32 | r;
+  std::uint64_t y = std::uint64_t(k) << 32 | a;
+  return hash_mix(x ^ hash_secret[0], y ^ hash_secret[1]);
+}
+
+
+inline
+Flat_builder::Flat_builder()
+  : table_(64, Flat_prop::no_index)
+{ }
+
+
+// Returns the index of the atom with id n.
+inline std::uint32_t
+Flat_builder::make_atom(std::uint32_t n)
+{
+  return make(atom_prop, Flat_prop::no_index, Flat_prop::no_index, n);
+}
+
+
+// Returns the index of the negation of the node n.
+inline std::uint32_t
+Flat_builder::make_not(std::uint32_t n)
+{
+  return make(not_prop, n, Flat_prop::no_index, Flat_prop::no_index);
+}
+
+
+// Returns the index of the binary node of kind k with
+// operands l and r.
+inline std::uint32_t
+Flat_builder::make_binary(Prop_kind k, std::uint32_t l, std::uint32_t r)
+{
+  return make(k, l, r, Flat_prop::no_index);
+}
+
+
+// Returns the index of the node with the given fields,
+// adding it if it does not exist.
+std::uint32_t
+Flat_builder::make(Prop_kind k, std::uint32_t l, std::uint32_t r, std::uint32_t a)
+{
+  if (2 * (prop_.size() + 1) > table_.size())
+    rehash();
+
+  std::size_t mask = table_.size() - 1;
+  std::size_t i = hash_node(k, l, r, a) & mask;
+  while (true) {
+    std::uint32_t n = table_[i];
+    if (n == Flat_prop::no_index)
+      break;
+    if (prop_.kind[n] == k && prop_.left[n] == l && prop_.right[n] == r && prop_.atom[n] == a)
+      return n;
+    i = (i + 1) & mask;
+  }
+
+  if (prop_.size() >= Flat_prop::no_index - 1)
+    throw std::length_error("too many nodes");
+  std::uint32_t n = prop_.size();
+  prop_.kind.push_back(k);
+  prop_.left.push_back(l);
+  prop_.right.push_back(r);
+  prop_.atom.push_back(a);
+  table_[i] = n;
+  return n;
+}
+
+
+// Double the size of the table.
+void
+Flat_builder::rehash()
+{
+  std::vector<std::uint32_t> table(2 * table_.size(), Flat_prop::no_index);
+  std::size_t mask = table.size() - 1;
+  for (std::uint32_t n = 0; n < prop_.size(); ++n) {
+    std::size_t i = hash_node(prop_.kind[n], prop_.left[n], prop_.right[n], prop_.atom[n]) & mask;
+    while (table[i] != Flat_prop::no_index)
+      i = (i + 1) & mask;
+    table[i] = n;
+  }
+  table_.swap(table);
+}
+
+
+// Add the nodes of p to the builder, and return the index
+// of its root.
+std::uint32_t
+Flat_builder::add(Flat_prop const& p)
+{
+  std::vector<std::uint32_t> map(p.size());
+  for (std::uint32_t i = 0; i < p.size(); ++i) {
+    if (p.kind[i] == atom_prop)
+      map[i] = make_atom(p.atom[i]);
+    else if (p.kind[i] == not_prop)
+      map[i] = make_not(map[p.left[i]]);
+    else
+      map[i] = make_binary(p.kind[i], map[p.left[i]], map[p.right[i]]);
+  }
+  return map[p.root()];
+}
+
+
+// Returns the proposition rooted at the node n, leaving
+// the builder empty. Nodes that are not reachable from n
+// are removed.
+Flat_prop
+Flat_builder::take(std::uint32_t n)
+{
+  Flat_prop p;
+  p.kind.swap(prop_.kind);
+  p.left.swap(prop_.left);
+  p.right.swap(prop_.right);
+  p.atom.swap(prop_.atom);
+  table_.assign(64, Flat_prop::no_index);
+
+  // Mark the reachable nodes. Since operands precede
+  // their uses, one backward scan finds all of them.
+  std::vector<std::uint32_t> map(n + 1, 0);
+  map[n] = 1;
+  for (std::uint32_t i = n + 1; i-- > 0; ) {
+    if (map[i] && p.left[i] != Flat_prop::no_index)
+      map[p.left[i]] = 1;
+    if (map[i] && p.right[i] != Flat_prop::no_index)
+      map[p.right[i]] = 1;
+  }
+
+  // Move each reachable node to its new index.
+  std::uint32_t k = 0;
+  for (std::uint32_t i = 0; i <= n; ++i) {
+    if (!map[i])
+      continue;
+    map[i] = k;
+    p.kind[k] = p.kind[i];
+    p.atom[k] = p.atom[i];
+    p.left[k] = p.left[i] != Flat_prop::no_index ? map[p.left[i]] : Flat_prop::no_index;
+    p.right[k] = p.right[i] != Flat_prop::no_index ? map[p.right[i]] : Flat_prop::no_index;
+    ++k;
+  }
+  p.kind.resize(k);
+  p.left.resize(k);
+  p.right.resize(k);
+  p.atom.resize(k);
+  return p;
+}
+
+} // namespace
+
+
+// -------------------------------------------------------------------------- //
+//                              Conversions
+
+// Returns the flat form of p. The ids of atoms are
+// assigned by the atom table.
+Flat_prop
+flatten(Prop const* p, Atom_table& atoms)
+{
+  Flat_builder b;
+  std::unordered_map<Prop const*, std::uint32_t> done;
+  std::vector<Prop const*> stack {p};
+  while (!stack.empty()) {
+    Prop const* q = stack.back();
+    if (done.count(q)) {
+      stack.pop_back();
+      continue;
+    }
+
+    // Visit the operands of a node before the node
+    // itself.
+    std::uint32_t n;
+    if (Binary const* r = as<Binary>(q)) {
+      auto i = done.find(r->left());
+      if (i == done.end()) {
+        stack.push_back(r->left());
+        continue;
+      }
+      auto j = done.find(r->right());
+      if (j == done.end()) {
+        stack.push_back(r->right());
+        continue;
+      }
+      n = b.make_binary(q->kind(), i->second, j->second);
+    } else if (Not const* r = as<Not>(q)) {
+      auto i = done.find(r->operand());
+      if (i == done.end()) {
+        stack.push_back(r->operand());
+        continue;
+      }
+      n = b.make_not(i->second);
+    } else {
+      n = b.make_atom(atoms.get(cast<Atom>(q)->symbol()));
+    }
+    done.emplace(q, n);
+    stack.pop_back();
+  }
+  return b.take(done[p]);
+}
+
+
+// Returns the proposition whose flat form is p. The
+// symbols of atoms are found in the atom table.
+Prop const*
+unflatten(Prop_factory& f, Flat_prop const& p, Atom_table const& atoms)
+{
+  std::vector<Prop const*> ps(p.size());
+  for (std::uint32_t i = 0; i < p.size(); ++i) {
+    switch (p.kind[i]) {
+      case atom_prop:
+        ps[i] = f.make_atom(atoms.symbol(p.atom[i]));
+        break;
+      case not_prop:
+        ps[i] = f.make_not(ps[p.left[i]]);
+        break;
+      case and_prop:
+        ps[i] = f.make_and(ps[p.left[i]], ps[p.right[i]]);
+        break;
+      case or_prop:
+        ps[i] = f.make_or(ps[p.left[i]], ps[p.right[i]]);
+        break;
+      case implies_prop:
+        ps[i] = f.make_implies(ps[p.left[i]], ps[p.right[i]]);
+        break;
+    }
+  }
+  return ps[p.root()];
+}
+
+
+// -------------------------------------------------------------------------- //
+//                              Operations
+
+// Returns the structural hash of p. This is the same as
+// the hash of the corresponding proposition.
+std::uint64_t
+hash_value(Flat_prop const& p, Atom_table const& atoms)
+{
+  std::vector<std::uint64_t> h(p.size());
+  for (std::uint32_t i = 0; i < p.size(); ++i) {
+    switch (p.kind[i]) {
+      case atom_prop: {
+        String const& s = atoms.symbol(p.atom[i])->spelling();
+        h[i] = hash_atom(s.data(), s.size());
+        break;
+      }
+      case not_prop:
+        h[i] = hash_unary(not_seed, h[p.left[i]]);
+        break;
+      case and_prop:
+        h[i] = hash_binary(and_seed, h[p.left[i]], h[p.right[i]]);
+        break;
+      case or_prop:
+        h[i] = hash_binary(or_seed, h[p.left[i]], h[p.right[i]]);
+        break;
+      case implies_prop:
+        h[i] = hash_binary(implies_seed, h[p.left[i]], h[p.right[i]]);
+        break;
+    }
+  }
+  return h[p.root()];
+}
+
+
+// Returns true if a and b are structurally equal. The
+// ids of atoms in both must come from the same table.
+//
+// Both are added to a single builder, which assigns the
+// same index to equal nodes.
+bool
+is_equivalent(Flat_prop const& a, Flat_prop const& b)
+{
+  Flat_builder c;
+  return c.add(a) == c.add(b);
+}
+
+
+// Returns the value of p, where the value of the atom
+// with id n is v[n].
+bool
+evaluate(Flat_prop const& p, std::vector<bool> const& v)
+{
+  std::vector<char> r(p.size());
+  for (std::uint32_t i = 0; i < p.size(); ++i) {
+    switch (p.kind[i]) {
+      case atom_prop:
+        r[i] = v[p.atom[i]];
+        break;
+      case not_prop:
+        r[i] = !r[p.left[i]];
+        break;
+      case and_prop:
+        r[i] = r[p.left[i]] & r[p.right[i]];
+        break;
+      case or_prop:
+        r[i] = r[p.left[i]] | r[p.right[i]];
+        break;
+      case implies_prop:
+        r[i] = (!r[p.left[i]]) | r[p.right[i]];
+        break;
+    }
+  }
+  return r[p.root()];
+}
+
+
+namespace
+{
+
+// Simplify the binary node of kind k with simplified
+// operands p1 and p2, where d is the dual of k. This
+// applies the same rules as simplify() on propositions.
+std::uint32_t
+simplify_binary(Flat_builder& b, Prop_kind k, Prop_kind d, std::uint32_t p1, std::uint32_t p2)
+{
+  // idempotence: p and p <=> p
+  if (p1 == p2)
+    return p1;
+
+  // absorption: p and (p or q) <=> p
+  if (b.kind(p2) == d) {
+    if (p1 == b.left(p2) || p1 == b.right(p2))
+      return p1;
+  } else if (b.kind(p1) == d) {
+    if (p2 == b.left(p1) || p2 == b.right(p1))
+      return p2;
+  }
+
+  // contraction: p and (p and q) <=> p and q
+  if (b.kind(p2) == k) {
+    if (p1 == b.left(p2) || p1 == b.right(p2))
+      return p2;
+  } else if (b.kind(p1) == k) {
+    if (p2 == b.left(p1) || p2 == b.right(p1))
+      return p1;
+  }
+
+  return b.make_binary(k, p1, p2);
+}
+
+} // namespace
+
+
+// Returns a simplified form of p.
+Flat_prop
+simplify(Flat_prop const& p)
+{
+  Flat_builder b;
+  std::vector<std::uint32_t> map(p.size());
+  for (std::uint32_t i = 0; i < p.size(); ++i) {
+    switch (p.kind[i]) {
+      case atom_prop:
+        map[i] = b.make_atom(p.atom[i]);
+        break;
+      case not_prop: {
+        // double negation: not not p <=> p
+        std::uint32_t n = map[p.left[i]];
+        map[i] = b.kind(n) == not_prop ? b.left(n) : b.make_not(n);
+        break;
+      }
+      case and_prop:
+        map[i] = simplify_binary(b, and_prop, or_prop, map[p.left[i]], map[p.right[i]]);
+        break;
+      case or_prop:
+        map[i] = simplify_binary(b, or_prop, and_prop, map[p.left[i]], map[p.right[i]]);
+        break;
+      case implies_prop:
+        map[i] = b.make_binary(implies_prop, map[p.left[i]], map[p.right[i]]);
+        break;
+    }
+  }
+  return b.take(map[p.root()]);
+}
@@ -0,0 +1,89 @@
+
+#ifndef FLAT_HPP
+#define FLAT_HPP
+
+#include "ast.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+
+// -------------------------------------------------------------------------- //
+//                              Atom table
+
+// The atom table assigns dense, 32-bit identifiers to the
+// symbols of atoms, in the order they are first seen.
+class Atom_table
+{
+public:
+  std::uint32_t get(Symbol const*);
+  Symbol const* symbol(std::uint32_t) const;
+  std::size_t   size() const;
+
+private:
+  std::unordered_map<Symbol const*, std::uint32_t> ids_;  // Symbol to id
+  std::vector<Symbol const*>                       syms_; // Id to symbol
+};
+
+
+// Returns the symbol of the atom with id n.
+inline Symbol const*
+Atom_table::symbol(std::uint32_t n) const
+{
+  return syms_[n];
+}
+
+
+// Returns the number of atoms in the table.
+inline std::size_t
+Atom_table::size() const
+{
+  return syms_.size();
+}
+
+
+// -------------------------------------------------------------------------- //
+//                          Flat propositions
+
+// A flat proposition stores a proposition as parallel
+// arrays indexed by node. For each node, kind is its kind.
+// For a binary node, left and right are the indexes of its
+// operands. For a negation, left is the index of its
+// operand. For an atom, atom is the id of its symbol in
+// an atom table. Unused fields hold no_index.
+//
+// Nodes are stored in post-order: the operands of a node
+// always precede it, and the last node is the root. Each
+// distinct subproposition is stored once, so a proposition
+// whose subtrees are shared is stored as a DAG.
+//
+// All operations on a flat proposition are linear scans
+// over these arrays.
+struct Flat_prop
+{
+  static constexpr std::uint32_t no_index = -1;
+
+  std::uint32_t size() const { return kind.size(); }
+  std::uint32_t root() const { return kind.size() - 1; }
+
+  std::vector<Prop_kind>     kind;
+  std::vector<std::uint32_t> left;
+  std::vector<std::uint32_t> right;
+  std::vector<std::uint32_t> atom;
+};
+
+
+// Conversions
+Flat_prop   flatten(Prop const*, Atom_table&);
+Prop const* unflatten(Prop_factory&, Flat_prop const&, Atom_table const&);
+
+
+// Operations
+std::uint64_t hash_value(Flat_prop const&, Atom_table const&);
+bool          is_equivalent(Flat_prop const&, Flat_prop const&);
+bool          evaluate(Flat_prop const&, std::vector<bool> const&);
+Flat_prop     simplify(Flat_prop const&);
+
+
+#endif
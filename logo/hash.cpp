@@ -2,47 +2,126 @@
 #include "hash.hpp"
 #include "ast.hpp"
 
-#include <boost/functional/hash.hpp>
+#include <cstring>
 
 
-std::size_t
-hash_value(Atom const* p)
+namespace
 {
-  std::hash<void const*> h;
-  return h(p->symbol());
+
+// Read 8 bytes at p as a little-endian word.
+inline std::uint64_t
+read8(unsigned char const* p)
+{
+  std::uint64_t v;
+  std::memcpy(&v, p, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  v = __builtin_bswap64(v);
+#endif
+  return v;
 }
 
 
-std::size_t
-hash_value(And const* p)
+// Read 4 bytes at p as a little-endian word.
+inline std::uint64_t
+read4(unsigned char const* p)
 {
-  std::size_t seed;
-  boost::hash_combine(seed, p->left());
-  boost::hash_combine(seed, p->right());
-  return seed;
+  std::uint32_t v;
+  std::memcpy(&v, p, 4);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  v = __builtin_bswap32(v);
+#endif
+  return v;
 }
 
 
-// FIXME: Handle precedence.
-std::size_t
-hash_value(Or const* p)
+// Read 1 to 3 bytes at p.
+inline std::uint64_t
+read3(unsigned char const* p, std::size_t n)
 {
-  std::size_t seed;
-  boost::hash_combine(seed, p->left());
-  boost::hash_combine(seed, p->right());
-  return seed;
+  return (std::uint64_t(p[0]) << 16) | (std::uint64_t(p[n >> 1]) << 8) | p[n - 1];
+}
+
+
+// Returns the 128-bit product of a and b in a (low)
+// and b (high).
+inline void
+mum(std::uint64_t& a, std::uint64_t& b)
+{
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 r = a;
+  r *= b;
+  a = std::uint64_t(r);
+  b = std::uint64_t(r >> 64);
+#else
+  std::uint64_t ha = a >> 32, hb = b >> 32, la = std::uint32_t(a), lb = std::uint32_t(b);
+  std::uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  std::uint64_t t = rl + (rm0 << 32);
+  std::uint64_t c = t < rl;
+  std::uint64_t lo = t + (rm1 << 32);
+  c += lo < t;
+  std::uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+  a = lo;
+  b = hi;
+#endif
+}
+
+} // namespace
+
+
+// Returns the wyhash (final version 4) of the n bytes at
+// data with the given seed and the default secret. See the
+// description of the hash format in hash.hpp.
+std::uint64_t
+hash_bytes(void const* data, std::size_t n, std::uint64_t seed)
+{
+  std::uint64_t const* s = hash_secret;
+  unsigned char const* p = static_cast<unsigned char const*>(data);
+  seed ^= hash_mix(seed ^ s[0], s[1]);
+
+  std::uint64_t a, b;
+  if (n <= 16) {
+    if (n >= 4) {
+      a = (read4(p) << 32) | read4(p + ((n >> 3) << 2));
+      b = (read4(p + n - 4) << 32) | read4(p + n - 4 - ((n >> 3) << 2));
+    } else if (n > 0) {
+      a = read3(p, n);
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    std::size_t i = n;
+    if (i > 48) {
+      std::uint64_t see1 = seed, see2 = seed;
+      do {
+        seed = hash_mix(read8(p) ^ s[1], read8(p + 8) ^ seed);
+        see1 = hash_mix(read8(p + 16) ^ s[2], read8(p + 24) ^ see1);
+        see2 = hash_mix(read8(p + 32) ^ s[3], read8(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = hash_mix(read8(p) ^ s[1], read8(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    a = read8(p + i - 16);
+    b = read8(p + i - 8);
+  }
+
+  a ^= s[1];
+  b ^= seed;
+  mum(a, b);
+  return hash_mix(a ^ s[0] ^ n, b ^ s[1]);
 }
 
 
-std::size_t
+// Returns the structural hash of p. This is computed
+// when p is constructed, so this takes constant time.
+std::uint64_t
 hash_value(Prop const* p)
 {
-  struct Fn
-  {
-    std::size_t operator()(Atom const* p) const { return hash_value(p); }
-    std::size_t operator()(And const* p) const { return hash_value(p); }
-    std::size_t operator()(Or const* p) const { return hash_value(p); }
-  };
-  
-  return apply(p, Fn());
+  return p->hash();
 }
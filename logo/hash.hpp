@@ -2,13 +2,114 @@
 #ifndef HASH_HPP
 #define HASH_HPP
 
+#include <cstdint>
 #include <cstdlib>
 
 
 struct Prop;
 
 
-std::size_t hash_value(Prop const* p);
+// -------------------------------------------------------------------------- //
+//                            Hash format
+//
+// Structural hashes are 64-bit values that depend only on
+// the spellings of atoms and the structure of a proposition,
+// never on addresses, so they are the same in every process
+// and on every platform. They are computed as follows
+// (version 1):
+//
+//    hash(s)       = wyhash(spelling of s, atom_seed)
+//    hash(not a)   = mix(mix(hash(a) ^ s0, not_seed ^ s1), s2)
+//    hash(a and b) = mix(mix(hash(a) ^ s0, and_seed ^ s1) ^ hash(b), s2)
+//    hash(a or b)  = mix(mix(hash(a) ^ s0, or_seed ^ s1) ^ hash(b), s2)
+//    hash(a -> b)  = mix(mix(hash(a) ^ s0, implies_seed ^ s1) ^ hash(b), s2)
+//
+// where wyhash is the final (version 4) wyhash function
+// over the bytes of the spelling, s0, s1, and s2 are the
+// first three words of hash_secret, and mix(a, b) is the
+// exclusive or of the high and low words of the 128-bit
+// product of a and b.
+//
+// Any change to these definitions or constants changes
+// the hash of existing propositions, and must be made as
+// a new version of the format.
+
+
+// The secret of the default wyhash parameters.
+constexpr std::uint64_t hash_secret[4] = {
+  0x2d358dccaa6c78a5, 0x8bb84b93962eacc9,
+  0x4b33a62ed433d4a3, 0x4d5a2da51de1aa47,
+};
+
+
+// Seeds distinguishing the kinds of propositions, so that
+// an And and an Or of the same operands hash differently.
+constexpr std::uint64_t atom_seed    = 0x243f6a8885a308d3;
+constexpr std::uint64_t and_seed     = 0x13198a2e03707344;
+constexpr std::uint64_t or_seed      = 0xa4093822299f31d0;
+constexpr std::uint64_t not_seed     = 0x082efa98ec4e6c89;
+constexpr std::uint64_t implies_seed = 0x452821e638d01377;
+
+
+// Returns the exclusive or of the high and low words of
+// the 128-bit product of a and b.
+inline std::uint64_t
+hash_mix(std::uint64_t a, std::uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 r = a;
+  r *= b;
+  return std::uint64_t(r) ^ std::uint64_t(r >> 64);
+#else
+  std::uint64_t ha = a >> 32, hb = b >> 32, la = std::uint32_t(a), lb = std::uint32_t(b);
+  std::uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  std::uint64_t t = rl + (rm0 << 32);
+  std::uint64_t c = t < rl;
+  std::uint64_t lo = t + (rm1 << 32);
+  c += lo < t;
+  std::uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+  return lo ^ hi;
+#endif
+}
+
+
+std::uint64_t hash_bytes(void const*, std::size_t, std::uint64_t);
+
+
+// Returns the structural hash of an atom with the n
+// characters of spelling s.
+inline std::uint64_t
+hash_atom(char const* s, std::size_t n)
+{
+  return hash_bytes(s, n, atom_seed);
+}
+
+
+// Returns the structural hash of a unary proposition
+// whose operator has the given seed and whose operand
+// has the hash h.
+inline std::uint64_t
+hash_unary(std::uint64_t seed, std::uint64_t h)
+{
+  return hash_mix(hash_mix(h ^ hash_secret[0], seed ^ hash_secret[1]), hash_secret[2]);
+}
+
+
+// Returns the structural hash of a binary proposition
+// whose operator has the given seed and whose operands
+// have the hashes h1 and h2.
+inline std::uint64_t
+hash_binary(std::uint64_t seed, std::uint64_t h1, std::uint64_t h2)
+{
+  std::uint64_t h = hash_mix(h1 ^ hash_secret[0], seed ^ hash_secret[1]);
+  return hash_mix(h ^ h2, hash_secret[2]);
+}
+
+
+// -------------------------------------------------------------------------- //
+//                              Hashing
+
+std::uint64_t hash_value(Prop const* p);
 
 
 #endif
@@ -2,9 +2,6 @@
 #include "lexer.hpp"
 
 
-#include <iostream>
-
-
 // Returns the next token in the character stream.
 // If no next token can be identified, an error
 // is emitted and we return the error token.
@@ -13,6 +10,7 @@ Lexer::scan()
 {
   // Consume any white space here.
   space();
+  start_ = cs_.offset();
 
   switch (peek()) {
     case 0: return eof();
@@ -47,9 +45,10 @@ Lexer::on_symbol(int n, Token_kind k)
   char const* last = first + n;
   ignore(n);
 
-  // Get the symbol and return the token.
-  Symbol const* sym = syms_.get(String(first, last));
-  return Token(k, sym);
+  // Get the symbol, installing it if needed, and
+  // return the token.
+  Symbol const* sym = syms_.put<Symbol>(first, last, k);
+  return Token(k, sym, start_);
 }
 
 
@@ -60,17 +59,15 @@ Lexer::on_identifier(char const* first, char const* last)
   // Lookup the symbol first.
   String str(first, last);  
   if (Symbol const* sym = syms_.get(str))
-    return Token(sym->token(), sym);
+    return Token(sym->token(), sym, start_);
 
   // Create a new symbol.  
   Symbol* sym = syms_.put<Identifier_sym>(str, identifier_tok);
-  return Token(identifier_tok, sym);
+  return Token(identifier_tok, sym, start_);
 }
 
 
 // Consume horizontal and vertical whitespace.
-//
-// TODO: Manage the input location while lexing.
 void
 Lexer::space()
 {
@@ -88,14 +85,154 @@ Lexer::space()
 
 // Set the error flag and return an invalid token.
 // This also consumes the current character so that
-// we can continue lexing.
+// we can continue lexing. A byte that does not start
+// a well-formed UTF-8 sequence is consumed by itself.
+//
+// The error is recorded in the diagnostic sink rather
+// than written immediately.
 inline Token
 Lexer::error()
 {
-  // TODO: Improve diagnostics.
-  std::cerr << "error: invalid character '" << peek() << "'\n";
+  int n = 1;
+  Diagnostic_code c = invalid_character_diag;
+  if (!is_ascii(peek())) {
+    char32_t u;
+    n = decode(u);
+    if (!n) {
+      n = 1;
+      c = invalid_encoding_diag;
+    }
+  }
+  diags_.error(cs_.offset(), c, n);
 
   state_ |= error_flag;
-  get();
+  ignore(n);
   return Token();
 }
+
+
+// Returns the offset past the last character of tok.
+static inline Offset
+token_end(Token const& tok)
+{
+  return tok.offset() + tok.spelling().size();
+}
+
+
+// Apply the edit e to the character stream and update
+// the tokens in ts to match. Only the tokens affected
+// by the edit are re-lexed and replaced. The stream
+// is rewound so that it can be parsed again.
+//
+// Lexing restarts at the end of the last token that
+// ends before the edit, if only whitespace lies between
+// that token and the edit. Other characters there were
+// lexed as errors, and the edit can join them to that
+// token (e.g., by completing a UTF-8 sequence after an
+// identifier), so lexing restarts at the start of that
+// token instead.
+//
+// New tokens are produced until one starts at the
+// (shifted) offset of an old token following the edit.
+// From that point on, both scans see the same text, so
+// the remaining tokens are unchanged and only their
+// offsets are adjusted.
+//
+// Only the characters of the edited region are lexed,
+// but an edit still takes O(N) time in the size of the
+// buffer: the buffer is a contiguous string, so applying
+// the edit moves the text after it, and finding the
+// restart point and shifting offsets are linear walks
+// over the token list.
+Token_edit
+Lexer::relex(Token_stream& ts, Edit const& e)
+{
+  Tokenbuf& buf = ts.buffer();
+  Offset end = e.offset + e.length;
+  Offset delta = e.text.size() - e.length; // Wraps when shrinking
+
+  // Find the first token that could be affected by the
+  // edit. A token ending exactly at the edit could be
+  // extended by it.
+  Offset restart = 0;
+  Tokenbuf::iterator first = buf.begin();
+  while (first != buf.end() && token_end(*first) < e.offset) {
+    restart = token_end(*first);
+    ++first;
+  }
+
+  // Restart at the previous token if the characters after
+  // it are not all whitespace.
+  char const* text = cs_.buffer().begin();
+  for (Offset i = restart; i < e.offset; ++i) {
+    if (!is_space(text[i]) && !is_newline(text[i])) {
+      if (first != buf.begin())
+        restart = (--first)->offset();
+      break;
+    }
+  }
+
+  // The valid prefix before the edit ends at the start of
+  // the character containing the edit. The valid text after
+  // the edit is still valid if it starts a character.
+  Offset valid = std::min(valid_, e.offset);
+  while (valid != 0 && valid < valid_ && is_continuation(text[valid]))
+    --valid;
+  bool rest = end < valid_ && !is_continuation(text[end]);
+  Offset rest_valid = valid_ + delta;
+
+  cs_.apply(e);
+  cs_.seek(restart);
+  state_ &= ~eof_flag;
+
+  // Validate the inserted text, and extend the valid prefix
+  // over it, and over the rest of the old valid text when
+  // the inserted text is valid.
+  text = cs_.buffer().begin();
+  Offset inserted = e.offset + e.text.size();
+  valid_ = find_invalid_utf8(text + valid, text + inserted) - text;
+  if (valid_ == inserted && rest)
+    valid_ = rest_valid;
+
+  // Scan until we resynchronize with the old tokens
+  // or reach the end of input.
+  Tokenbuf toks;
+  Tokenbuf::iterator last = first;
+  while (true) {
+    Token tok = scan();
+    if (done()) {
+      last = buf.end();
+      break;
+    }
+    if (!tok)
+      continue;
+
+    // Skip old tokens that overlap the edit or that start
+    // before the new token.
+    while (last != buf.end()) {
+      if (last->offset() >= end && last->offset() + delta >= tok.offset())
+        break;
+      ++last;
+    }
+    if (last != buf.end() && last->offset() + delta == tok.offset())
+      break;
+
+    toks.push_back(tok);
+  }
+
+  // Replace the old tokens by the new ones.
+  Token_edit r;
+  r.last = last;
+  r.first = toks.empty() ? last : toks.begin();
+  r.removed.splice(r.removed.end(), buf, first, last);
+  buf.splice(last, toks);
+
+  // Shift the tokens following the edit.
+  if (delta) {
+    for (Tokenbuf::iterator i = last; i != buf.end(); ++i)
+      *i = Token(i->kind(), i->symbol(), i->offset() + delta);
+  }
+
+  ts.rewind();
+  return r;
+}
@@ -4,14 +4,21 @@
 
 #include "string.hpp"
 #include "token.hpp"
-
-#include <cassert>
-#include <cctype>
+#include "diagnostics.hpp"
+#include "unicode.hpp"
 
 
 // The lexer is responsible for the transformation
 // of a character stream into a list of tokens.
-// FIXME: Maintain source code locations.
+//
+// Each token records the byte offset at which it
+// starts. Lines and columns are not tracked during
+// lexing; see Line_map.
+//
+// The input is UTF-8. Before lexing, the buffer is
+// validated once, and characters in the valid prefix
+// are decoded without further checks. After an edit,
+// only the inserted text is validated again.
 class Lexer
 {
 public:
@@ -19,7 +26,7 @@ public:
   static constexpr State_flags eof_flag   = 0x01;
   static constexpr State_flags error_flag = 0x02;
 
-  Lexer(Symbol_table&, Char_stream&);
+  Lexer(Symbol_table&, Char_stream&, Diagnostics&);
 
   // Lexer state
   bool done() const;
@@ -29,6 +36,9 @@ public:
   bool lex(Token_stream&);
   bool scan(Token_stream&);
 
+  // Incremental lexing
+  Token_edit relex(Token_stream&, Edit const&);
+
   // Scanning
   Token scan();
   Token lparen();
@@ -49,19 +59,24 @@ private:
   char peek(int n) const   { return cs_.peek(n); }
   char get() const         { return cs_.get(); }
   void ignore(int n) const { return cs_.ignore(n); }
+  int  decode(char32_t&) const;
+  void validate();
 
   void space();
-  void letter();
+  int  letter(Char_class);
 
   State_flags   state_; // The lexer's state
+  Offset        start_; // The offset of the current token
+  Offset        valid_; // The length of the valid UTF-8 prefix
   Symbol_table& syms_;  // The symbol table
   Char_stream&  cs_;    // The character stream
+  Diagnostics&  diags_; // The diagnostic sink
 };
 
 
 inline
-Lexer::Lexer(Symbol_table& s, Char_stream& cs)
-  : syms_(s), cs_(cs)
+Lexer::Lexer(Symbol_table& s, Char_stream& cs, Diagnostics& d)
+  : state_(0), start_(0), valid_(0), syms_(s), cs_(cs), diags_(d)
 { }
 
 
@@ -89,6 +104,7 @@ Lexer::failed() const
 inline bool
 Lexer::lex(Token_stream& ts)
 {
+  validate();
   while (!done())
     scan(ts);
   return !failed();
@@ -129,16 +145,64 @@ Lexer::arrow()
 }
 
 
-// letter ::= [a-z]
+// Find the longest prefix of the buffer that is valid
+// UTF-8.
 inline void
-Lexer::letter()
+Lexer::validate()
 {
-  assert(std::isalpha(peek()));
-  get();
+  char const* first = cs_.buffer().begin();
+  char const* last = cs_.buffer().end();
+  valid_ = find_invalid_utf8(first, last) - first;
 }
 
 
-// identifier ::= letter+
+// Decode the character at the current position into c,
+// returning its length, or 0 if it is not well-formed.
+inline int
+Lexer::decode(char32_t& c) const
+{
+  char const* p = cs_.position();
+  if (cs_.offset() < valid_)
+    return decode_utf8(p, c);
+  else
+    return decode_utf8(p, cs_.buffer().end(), c);
+}
+
+
+// letter ::= start-letter | continue-letter
+//
+// If the current character is in the class k, consume
+// it and return its length. Otherwise, return 0.
+//
+// ASCII characters are classified by table lookup. Only
+// other characters are decoded and looked up in the
+// Unicode tables.
+inline int
+Lexer::letter(Char_class k)
+{
+  char c = peek();
+  if (is_ascii(c)) {
+    if (!(ascii_class[int(c)] & k))
+      return 0;
+    get();
+    return 1;
+  }
+
+  char32_t u;
+  int n = decode(u);
+  if (!n)
+    return 0;
+  if (k == ident_start_class ? !is_ident_start(u) : !is_ident_continue(u))
+    return 0;
+  ignore(n);
+  return n;
+}
+
+
+// identifier ::= start-letter continue-letter*
+//
+// Returns an invalid token if the current character
+// cannot start an identifier.
 //
 // Note that this also recognizes keywords.
 // Those are differentiated by the semantic
@@ -147,9 +211,10 @@ inline Token
 Lexer::identifier()
 {
   char const* first = cs_.position();
-  letter();
-  while (std::isalpha(peek()))
-    letter();
+  if (!letter(ident_start_class))
+    return Token();
+  while (letter(ident_continue_class))
+    ;
   char const* last = cs_.position();
   return on_identifier(first, last);
 }
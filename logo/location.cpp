@@ -0,0 +1,57 @@
+
+#include "location.hpp"
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+
+// Returns the line and column of the byte at offset n.
+Location
+Line_map::resolve(Offset n) const
+{
+  if (!done_)
+    index();
+
+  // The number of newlines before n is the 0-based
+  // line number. The column is measured from the byte
+  // after the preceding newline.
+  auto iter = std::lower_bound(lines_.begin(), lines_.end(), n);
+  unsigned line = iter - lines_.begin();
+  Offset start = line ? lines_[line - 1] + 1 : 0;
+  return {line + 1, n - start + 1};
+}
+
+
+// Record the offset of each newline in the buffer.
+//
+// When SSE2 is available, the buffer is scanned 16 bytes
+// at a time, and only blocks containing a newline are
+// inspected bit by bit.
+void
+Line_map::index() const
+{
+  char const* first = buf_.begin();
+  char const* last = buf_.end();
+  char const* p = first;
+
+#if defined(__SSE2__)
+  __m128i const nl = _mm_set1_epi8('\n');
+  for (; last - p >= 16; p += 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+    unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, nl));
+    while (mask) {
+      lines_.push_back(p - first + __builtin_ctz(mask));
+      mask &= mask - 1;
+    }
+  }
+#endif
+
+  for (; p != last; ++p)
+    if (is_newline(*p))
+      lines_.push_back(p - first);
+
+  done_ = true;
+}
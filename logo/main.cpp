@@ -5,6 +5,8 @@
 #include "ast.hpp"
 #include "hash.hpp"
 #include "simplify.hpp"
+#include "normalize.hpp"
+#include "nnf.hpp"
 
 #include <iostream>
 
@@ -28,6 +30,7 @@ main()
   Symbol_table syms;
   install_keyword(syms, "and", and_tok);
   install_keyword(syms, "or",  or_tok);
+  install_keyword(syms, "not", not_tok);
   
   // Create the initial streambuf. This reads from cin.
   Char_stream cs = cin;
@@ -36,18 +39,28 @@ main()
   // by the lexer.
   Token_stream ts;
 
-  // Build and run the lexer.
-  Lexer lex(syms, cs);
+  // Build and run the lexer. Lexical errors are collected
+  // by the diagnostic sink and reported once at the end.
+  Diagnostics diags;
+  Lexer lex(syms, cs, diags);
   lex.lex(ts);
+  diags.flush(cerr, cs.buffer());
 
-  // Parse.
-  Parser parse(ts);
+  // Parse. All propositions are owned by the factory.
+  Prop_factory props;
+  Parser parse(ts, props);
   Prop const* p1 = parse.proposition();
   std::cout << "input:  " << p1 << '\n';
   
-  Prop const* p2 = simplify(p1);
+  Prop const* p2 = simplify(props, p1);
   std::cout << "simple: " << p2 << '\n';
 
+  Prop const* p3 = normalize(props, p1);
+  std::cout << "normal: " << p3 << '\n';
+
+  Prop const* p4 = nnf(props, p1);
+  std::cout << "nnf:    " << p4 << '\n';
+
   std::cout << hash_value(p1) << '\n';
   std::cout << hash_value(p2) << '\n';
 }
@@ -0,0 +1,513 @@
+
+#include "minimize.hpp"
+#include "ast.hpp"
+#include "truth.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+namespace
+{
+
+// -------------------------------------------------------------------------- //
+//                                 Cubes
+
+// A cube is a conjunction of literals over atoms numbered
+// from 0, stored as 2 bits per atom, 32 atoms per word.
+// Bit 0 of the field of an atom is set if the cube allows
+// the atom to be false, and bit 1 if it allows it to be
+// true:
+//
+//    01   the negative literal
+//    10   the positive literal
+//    11   the atom does not occur
+//    00   no assignment: the cube is empty
+//
+// Unused fields of the last word are 11, so they never
+// make a cube empty or count as literals.
+
+constexpr std::uint64_t low_bits = 0x5555555555555555;
+
+
+// Returns the mask of the field of atom v in its word.
+inline std::uint64_t
+field(std::size_t v)
+{
+  return std::uint64_t(3) << (2 * (v % 32));
+}
+
+
+// Returns true if the cube c is empty.
+inline bool
+is_empty(std::uint64_t const* c, std::size_t n)
+{
+  for (std::size_t i = 0; i < n; ++i)
+    if (((c[i] | (c[i] >> 1)) & low_bits) != low_bits)
+      return true;
+  return false;
+}
+
+
+// Returns true if the cubes a and b have no assignment in
+// common.
+inline bool
+is_disjoint(std::uint64_t const* a, std::uint64_t const* b, std::size_t n)
+{
+  for (std::size_t i = 0; i < n; ++i) {
+    std::uint64_t x = a[i] & b[i];
+    if (((x | (x >> 1)) & low_bits) != low_bits)
+      return true;
+  }
+  return false;
+}
+
+
+// Returns true if every assignment of b is one of a.
+inline bool
+contains(std::uint64_t const* a, std::uint64_t const* b, std::size_t n)
+{
+  for (std::size_t i = 0; i < n; ++i)
+    if (b[i] & ~a[i])
+      return false;
+  return true;
+}
+
+
+// Returns true if the cube has no literals.
+inline bool
+is_universal(std::uint64_t const* c, std::size_t n)
+{
+  for (std::size_t i = 0; i < n; ++i)
+    if (~c[i])
+      return false;
+  return true;
+}
+
+
+// Returns the number of literals of the cube c.
+inline std::size_t
+literals(std::uint64_t const* c, std::size_t n)
+{
+  std::size_t k = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    k += 32 - __builtin_popcountll(c[i] & (c[i] >> 1) & low_bits);
+  return k;
+}
+
+
+// -------------------------------------------------------------------------- //
+//                                 Covers
+
+// A cover is a disjunction of cubes, stored one after
+// another.
+struct Cover
+{
+  explicit Cover(std::size_t n)
+    : words(n)
+  { }
+
+  std::size_t size() const { return bits.size() / words; }
+
+  std::uint64_t*       operator[](std::size_t i) { return &bits[i * words]; }
+  std::uint64_t const* operator[](std::size_t i) const { return &bits[i * words]; }
+
+  void push(std::uint64_t const* c)
+  {
+    if (size() >= minimize_limit)
+      throw std::length_error("cover too large to minimize");
+    bits.insert(bits.end(), c, c + words);
+  }
+
+  std::size_t                words;
+  std::vector<std::uint64_t> bits;
+};
+
+
+// Returns the number of literals of the cover.
+std::size_t
+literals(Cover const& f)
+{
+  std::size_t k = 0;
+  for (std::size_t i = 0; i < f.size(); ++i)
+    k += literals(f[i], f.words);
+  return k;
+}
+
+
+// Returns the cubes of f in the given order.
+Cover
+permute(Cover const& f, std::vector<std::size_t> const& order)
+{
+  Cover r(f.words);
+  r.bits.reserve(order.size() * f.words);
+  for (std::size_t i : order)
+    r.push(f[i]);
+  return r;
+}
+
+
+// Returns the positions of the cubes of f, from the fewest
+// literals (the largest cube) to the most.
+std::vector<std::size_t>
+by_size(Cover const& f)
+{
+  std::vector<std::size_t> lits(f.size());
+  for (std::size_t i = 0; i < f.size(); ++i)
+    lits[i] = literals(f[i], f.words);
+  std::vector<std::size_t> order(f.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+    return lits[a] < lits[b];
+  });
+  return order;
+}
+
+
+// Returns f without the cubes that are contained in
+// another cube of f (single cube containment).
+Cover
+absorb(Cover const& f)
+{
+  Cover r(f.words);
+  for (std::size_t i : by_size(f)) {
+    bool covered = false;
+    for (std::size_t j = 0; j < r.size() && !covered; ++j)
+      covered = contains(r[j], f[i], f.words);
+    if (!covered)
+      r.push(f[i]);
+  }
+  return r;
+}
+
+
+// Returns the union of f and g.
+Cover
+make_or(Cover const& f, Cover const& g)
+{
+  Cover r = f;
+  for (std::size_t i = 0; i < g.size(); ++i)
+    r.push(g[i]);
+  return absorb(r);
+}
+
+
+// Returns the intersection of f and g: the nonempty
+// intersections of their cubes.
+Cover
+make_and(Cover const& f, Cover const& g)
+{
+  Cover r(f.words);
+  std::vector<std::uint64_t> c(f.words);
+  for (std::size_t i = 0; i < f.size(); ++i) {
+    for (std::size_t j = 0; j < g.size(); ++j) {
+      for (std::size_t k = 0; k < f.words; ++k)
+        c[k] = f[i][k] & g[j][k];
+      if (!is_empty(c.data(), f.words))
+        r.push(c.data());
+    }
+  }
+  return absorb(r);
+}
+
+
+// Returns the cofactor of f with respect to the cube c:
+// the cubes of f that meet c, with the atoms of c
+// removed.
+Cover
+cofactor(Cover const& f, std::uint64_t const* c)
+{
+  Cover r(f.words);
+  for (std::size_t i = 0; i < f.size(); ++i) {
+    if (is_disjoint(f[i], c, f.words))
+      continue;
+    std::size_t n = r.bits.size();
+    r.bits.resize(n + f.words);
+    for (std::size_t k = 0; k < f.words; ++k)
+      r.bits[n + k] = f[i][k] | ~c[k];
+  }
+  return r;
+}
+
+
+// Returns true if f is true under every assignment.
+//
+// This follows the unate recursive paradigm: f is split on
+// the atom that occurs most often in both polarities, and
+// is a tautology if both cofactors are. A cover in which
+// every atom occurs in only one polarity (a unate cover) is
+// a tautology only if it has the universal cube. The depth
+// of recursion is at most the number of atoms.
+bool
+is_tautology(Cover const& f, std::size_t atoms)
+{
+  for (std::size_t i = 0; i < f.size(); ++i)
+    if (is_universal(f[i], f.words))
+      return true;
+  if (f.size() == 0)
+    return false;
+
+  std::size_t best = atoms;
+  std::size_t most = 0;
+  for (std::size_t v = 0; v < atoms; ++v) {
+    std::size_t pos = 0, neg = 0;
+    for (std::size_t i = 0; i < f.size(); ++i) {
+      std::uint64_t x = (f[i][v / 32] & field(v)) >> (2 * (v % 32));
+      pos += x == 2;
+      neg += x == 1;
+    }
+    if (pos && neg && pos + neg > most) {
+      best = v;
+      most = pos + neg;
+    }
+  }
+  if (best == atoms)
+    return false;
+
+  std::vector<std::uint64_t> c(f.words, ~std::uint64_t(0));
+  std::uint64_t m = field(best);
+  c[best / 32] &= ~m | (m & ~low_bits);
+  if (!is_tautology(cofactor(f, c.data()), atoms))
+    return false;
+  c[best / 32] = ~m | (m & low_bits);
+  return is_tautology(cofactor(f, c.data()), atoms);
+}
+
+
+// Returns true if the cube c is covered by the cubes of f,
+// except the cube at position skip.
+bool
+is_covered(Cover const& f, std::size_t skip, std::uint64_t const* c, std::size_t atoms)
+{
+  Cover g(f.words);
+  for (std::size_t i = 0; i < f.size(); ++i)
+    if (i != skip)
+      g.bits.insert(g.bits.end(), f[i], f[i] + f.words);
+  return is_tautology(cofactor(g, c), atoms);
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Espresso passes
+
+// Expand each cube of f into a prime implicant: remove
+// each of its literals in turn, unless that makes it meet
+// a cube of the off-set r. Cubes are expanded from the
+// largest, and cubes contained in an expanded cube are
+// dropped.
+Cover
+expand(Cover const& f, Cover const& r, std::size_t atoms)
+{
+  std::size_t n = f.words;
+  Cover g(n);
+  std::vector<std::uint64_t> c(n);
+  for (std::size_t i : by_size(f)) {
+    bool covered = false;
+    for (std::size_t j = 0; j < g.size() && !covered; ++j)
+      covered = contains(g[j], f[i], n);
+    if (covered)
+      continue;
+
+    std::copy(f[i], f[i] + n, c.begin());
+    for (std::size_t v = 0; v < atoms; ++v) {
+      std::uint64_t& w = c[v / 32];
+      std::uint64_t m = field(v);
+      if ((w & m) == m)
+        continue;
+      std::uint64_t old = w;
+      w |= m;
+      for (std::size_t k = 0; k < r.size(); ++k) {
+        if (!is_disjoint(c.data(), r[k], n)) {
+          w = old;
+          break;
+        }
+      }
+    }
+    g.push(c.data());
+  }
+  return absorb(g);
+}
+
+
+// Remove redundant cubes from f: those covered by the
+// others. The smallest cubes are tried first.
+Cover
+irredundant(Cover const& f, std::size_t atoms)
+{
+  std::vector<std::size_t> order = by_size(f);
+  std::reverse(order.begin(), order.end());
+  Cover g = permute(f, order);
+  for (std::size_t i = g.size(); i-- > 0; ) {
+    if (is_covered(g, i, g[i], atoms))
+      g.bits.erase(g.bits.begin() + i * g.words, g.bits.begin() + (i + 1) * g.words);
+  }
+  return g;
+}
+
+
+// Reduce each cube of f to a smaller cube, while f still
+// covers the same assignments: an absent atom is added as
+// a literal if the other half of the cube is covered by
+// the other cubes. This lets the next expansion move
+// toward different primes.
+Cover
+reduce(Cover const& f, std::size_t atoms)
+{
+  std::size_t n = f.words;
+  Cover g = f;
+  std::vector<std::uint64_t> half(n);
+  for (std::size_t i = 0; i < g.size(); ++i) {
+    for (std::size_t v = 0; v < atoms; ++v) {
+      std::uint64_t m = field(v);
+      std::uint64_t& w = g[i][v / 32];
+      if ((w & m) != m)
+        continue;
+
+      // Try keeping the true half, then the false half.
+      for (std::uint64_t keep : {m & ~low_bits, m & low_bits}) {
+        std::copy(g[i], g[i] + n, half.begin());
+        half[v / 32] = (w & ~m) | (m & ~keep);
+        if (is_covered(g, i, half.data(), atoms)) {
+          w = (w & ~m) | keep;
+          break;
+        }
+      }
+    }
+  }
+  return g;
+}
+
+
+// Returns the cover of p, or of its negation if neg is
+// true, over the atoms numbered by index. Each node is
+// converted once for each polarity, as for nnf(), from an
+// explicit stack.
+Cover
+cover(Prop const* p, bool negate, std::unordered_map<Symbol const*, std::size_t> const& index, std::size_t words)
+{
+  using Item = std::pair<Prop const*, bool>;
+
+  std::unordered_map<Prop const*, Cover> memo[2];
+  std::vector<Item> work {{p, negate}};
+  while (!work.empty()) {
+    Prop const* q = work.back().first;
+    bool neg = work.back().second;
+    if (memo[neg].count(q)) {
+      work.pop_back();
+      continue;
+    }
+
+    Cover r(words);
+    if (Atom const* a = as<Atom>(q)) {
+      std::size_t v = index.find(a->symbol())->second;
+      std::vector<std::uint64_t> c(words, ~std::uint64_t(0));
+      c[v / 32] &= ~(field(v) & (neg ? ~low_bits : low_bits));
+      r.push(c.data());
+    } else if (Not const* x = as<Not>(q)) {
+      auto i = memo[!neg].find(x->operand());
+      if (i == memo[!neg].end()) {
+        work.emplace_back(x->operand(), !neg);
+        continue;
+      }
+      r = i->second;
+    } else {
+      Binary const* b = cast<Binary>(q);
+      bool lneg = is<Implies>(b) ? !neg : neg;
+      auto i = memo[lneg].find(b->left());
+      if (i == memo[lneg].end()) {
+        work.emplace_back(b->left(), lneg);
+        continue;
+      }
+      auto j = memo[neg].find(b->right());
+      if (j == memo[neg].end()) {
+        work.emplace_back(b->right(), neg);
+        continue;
+      }
+      bool conj = is<And>(b) ? !neg : neg;
+      if (conj)
+        r = make_and(i->second, j->second);
+      else
+        r = make_or(i->second, j->second);
+    }
+    memo[neg].emplace(q, std::move(r));
+    work.pop_back();
+  }
+  return std::move(memo[negate].find(p)->second);
+}
+
+} // namespace
+
+
+// Returns a minimal or near-minimal sum of products that
+// is equivalent to p. New propositions are created by the
+// factory f.
+//
+// The atoms of p are numbered, and covers of p (the
+// on-set) and of its negation (the off-set) are built by
+// distributing conjunctions over disjunctions. Then the
+// on-set is minimized as by Espresso: each cube is
+// expanded to a prime implicant that does not meet the
+// off-set, and redundant cubes are removed. While that
+// reduces the number of cubes or literals, the cubes are
+// reduced and the passes are repeated.
+//
+// The result is a disjunction of conjunctions of literals,
+// in the order of the atoms in p. Propositions have no
+// constants, so if p is unsatisfiable, the result is
+// "a and not a", and if p is valid, "a or not a", where a
+// is the first atom of p.
+//
+// A sum of products may be much larger than a nested form
+// of the same function, so this suits propositions that
+// are already close to two-level form. Throws
+// std::length_error if a cover exceeds minimize_limit
+// cubes.
+Prop const*
+minimize(Prop_factory& f, Prop const* p)
+{
+  std::vector<Symbol const*> syms = support(p);
+  std::unordered_map<Symbol const*, std::size_t> index;
+  for (std::size_t i = 0; i < syms.size(); ++i)
+    index.emplace(syms[i], i);
+  std::size_t atoms = syms.size();
+  std::size_t words = (atoms + 31) / 32;
+
+  Cover on = cover(p, false, index, words);
+  Cover off = cover(p, true, index, words);
+
+  Cover best = irredundant(expand(on, off, atoms), atoms);
+  while (true) {
+    Cover next = irredundant(expand(reduce(best, atoms), off, atoms), atoms);
+    if (next.size() > best.size())
+      break;
+    if (next.size() == best.size() && literals(next) >= literals(best))
+      break;
+    best = std::move(next);
+  }
+
+  Atom const* first = f.make_atom(syms[0]);
+  if (best.size() == 0)
+    return f.make_and(first, f.make_not(first));
+
+  Prop const* sum = nullptr;
+  for (std::size_t i = 0; i < best.size(); ++i) {
+    Prop const* product = nullptr;
+    for (std::size_t v = 0; v < atoms; ++v) {
+      std::uint64_t x = (best[i][v / 32] & field(v)) >> (2 * (v % 32));
+      if (x == 3)
+        continue;
+      Prop const* lit = f.make_atom(syms[v]);
+      if (x == 1)
+        lit = f.make_not(lit);
+      product = product ? f.make_and(product, lit) : lit;
+    }
+    if (!product)
+      return f.make_or(first, f.make_not(first));
+    sum = sum ? f.make_or(sum, product) : product;
+  }
+  return sum;
+}
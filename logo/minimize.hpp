@@ -0,0 +1,19 @@
+
+#ifndef MINIMIZE_HPP
+#define MINIMIZE_HPP
+
+#include <cstddef>
+
+
+struct Prop;
+class Prop_factory;
+
+
+// The most cubes in a cover built by minimize().
+constexpr std::size_t minimize_limit = 1 << 14;
+
+
+Prop const* minimize(Prop_factory&, Prop const*);
+
+
+#endif
@@ -0,0 +1,85 @@
+
+#include "nnf.hpp"
+#include "ast.hpp"
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+// Returns the negation normal form of p. New propositions
+// are created by the factory f.
+//
+// In negation normal form, implications are eliminated and
+// negations apply only to atoms:
+//
+//    a -> b       <=> not a or b
+//    not not a    <=> a
+//    not (a and b) <=> not a or not b
+//    not (a or b)  <=> not a and not b
+//    not (a -> b)  <=> a and not b
+//
+// Each node is converted at most once for each polarity
+// (whether it occurs under an odd number of negations),
+// and the results are recorded. Shared subpropositions
+// stay shared in the result, and the conversion takes
+// time linear in the number of distinct nodes of p, even
+// when its tree is exponentially larger. Nodes are visited
+// from an explicit stack, so p may be arbitrarily deep.
+Prop const*
+nnf(Prop_factory& f, Prop const* p)
+{
+  using Item = std::pair<Prop const*, bool>;
+
+  // The converted forms of nodes, for each polarity.
+  std::unordered_map<Prop const*, Prop const*> memo[2];
+
+  std::vector<Item> work {{p, false}};
+  while (!work.empty()) {
+    Prop const* q = work.back().first;
+    bool neg = work.back().second;
+    if (memo[neg].count(q)) {
+      work.pop_back();
+      continue;
+    }
+
+    Prop const* r;
+    if (is<Atom>(q)) {
+      r = neg ? (Prop const*)f.make_not(q) : q;
+    } else if (Not const* n = as<Not>(q)) {
+      auto i = memo[!neg].find(n->operand());
+      if (i == memo[!neg].end()) {
+        work.emplace_back(n->operand(), !neg);
+        continue;
+      }
+      r = i->second;
+    } else {
+      // The left operand of an implication has the
+      // opposite polarity.
+      Binary const* b = cast<Binary>(q);
+      bool lneg = is<Implies>(b) ? !neg : neg;
+      auto i = memo[lneg].find(b->left());
+      if (i == memo[lneg].end()) {
+        work.emplace_back(b->left(), lneg);
+        continue;
+      }
+      auto j = memo[neg].find(b->right());
+      if (j == memo[neg].end()) {
+        work.emplace_back(b->right(), neg);
+        continue;
+      }
+
+      // A conjunction stays a conjunction unless it is
+      // negated. An implication becomes a disjunction unless
+      // it is negated.
+      bool conj = is<And>(b) ? !neg : neg;
+      if (conj)
+        r = f.make_and(i->second, j->second);
+      else
+        r = f.make_or(i->second, j->second);
+    }
+    memo[neg].emplace(q, r);
+    work.pop_back();
+  }
+  return memo[0][p];
+}
@@ -0,0 +1,12 @@
+#ifndef NNF_HPP
+#define NNF_HPP
+
+
+struct Prop;
+class Prop_factory;
+
+
+Prop const* nnf(Prop_factory&, Prop const*);
+
+
+#endif
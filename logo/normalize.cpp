@@ -0,0 +1,203 @@
+
+#include "normalize.hpp"
+#include "ast.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+
+namespace
+{
+
+using Prop_seq = std::vector<Prop const*>;
+
+
+// A chain of operands of an associative operator. The
+// operands of a chain are normalized, but are not yet
+// sorted, deduplicated, or absorbed. Any other proposition
+// (an atom, negation or implication) is a chain of one
+// operand, with the kind atom_prop.
+struct Chain
+{
+  Prop_kind kind;
+  Prop_seq  ops;
+};
+
+
+// Append the operands of the chain of kind k rooted at
+// p to ops. Normalized chains are left-nested, and their
+// operands are never of kind k.
+void
+append_operands(Prop_seq& ops, Prop_kind k, Prop const* p)
+{
+  std::size_t n = ops.size();
+  while (p->kind() == k) {
+    Binary const* b = cast<Binary>(p);
+    ops.push_back(b->right());
+    p = b->left();
+  }
+  ops.push_back(p);
+  std::reverse(ops.begin() + n, ops.end());
+}
+
+
+// Order propositions by hash, and then by identity.
+inline bool
+hash_less(Prop const* a, Prop const* b)
+{
+  if (a->hash() != b->hash())
+    return a->hash() < b->hash();
+  return a < b;
+}
+
+
+// Returns the dual of the operator k.
+inline Prop_kind
+dual(Prop_kind k)
+{
+  return k == and_prop ? or_prop : and_prop;
+}
+
+
+// Returns the normalized proposition for the chain c.
+//
+// The operands are sorted by hash and duplicates are
+// removed, which accounts for associativity, commutativity
+// and idempotence. Then an operand of the dual operator is
+// removed when one of its own operands is also in the set,
+// or is a chain of this operator whose operands are all in
+// the set:
+//
+//    p and (p or q) <=> p
+//    p or (p and q) <=> p
+//    p and q and ((p and q) or r) <=> p and q
+//
+// The operand that absorbs it is never of the dual kind,
+// so at least one operand remains.
+Prop const*
+finish(Prop_factory& f, Chain& c)
+{
+  if (c.kind == atom_prop)
+    return c.ops[0];
+
+  Prop_seq& ops = c.ops;
+  std::sort(ops.begin(), ops.end(), hash_less);
+  ops.erase(std::unique(ops.begin(), ops.end()), ops.end());
+
+  // Absorb operands of the dual kind. Each operand of such
+  // an operand is looked up in the sorted set, or if it is
+  // a chain of kind k, each of its operands is.
+  Prop_kind d = dual(c.kind);
+  Prop_seq absorbed;
+  auto in_set = [&ops](Prop const* p) {
+    return std::binary_search(ops.begin(), ops.end(), p, hash_less);
+  };
+  auto absorbs = [&](Prop const* p) {
+    if (p->kind() != c.kind)
+      return in_set(p);
+    Prop_seq sub;
+    append_operands(sub, c.kind, p);
+    return std::all_of(sub.begin(), sub.end(), in_set);
+  };
+  for (Prop const* p : ops) {
+    if (p->kind() != d) {
+      absorbed.push_back(p);
+      continue;
+    }
+    Prop_seq sub;
+    append_operands(sub, d, p);
+    if (std::none_of(sub.begin(), sub.end(), absorbs))
+      absorbed.push_back(p);
+  }
+
+  Prop const* r = absorbed[0];
+  for (std::size_t i = 1; i < absorbed.size(); ++i)
+    r = c.kind == and_prop ? (Prop const*)f.make_and(r, absorbed[i])
+                           : (Prop const*)f.make_or(r, absorbed[i]);
+  return r;
+}
+
+
+// Add the operands of the chain c to the chain of kind k
+// in ops. If c has a different kind, it is normalized first.
+//
+// Operands are not ordered until the chain is finished, so
+// the shorter list is appended to the longer one. Each
+// operand is then copied O(log n) times, however the chain
+// is nested.
+void
+merge(Prop_factory& f, Prop_seq& ops, Prop_kind k, Chain& c)
+{
+  if (c.kind == k) {
+    if (ops.size() < c.ops.size())
+      std::swap(ops, c.ops);
+    ops.insert(ops.end(), c.ops.begin(), c.ops.end());
+    return;
+  }
+
+  // Absorption may leave a single operand of kind k, which
+  // is flattened into this chain.
+  Prop const* p = finish(f, c);
+  if (p->kind() == k)
+    append_operands(ops, k, p);
+  else
+    ops.push_back(p);
+}
+
+} // namespace
+
+
+// Returns the normal form of p. New propositions are
+// created by the factory f.
+//
+// Chains of 'and' and 'or' are flattened into sets of
+// operands, which are sorted by hash, deduplicated, and
+// absorbed as a whole. The operands of the result are
+// ordered by hash, so equivalent chains (up to these rules)
+// have the same normal form, and normalizing a normal form
+// returns it unchanged.
+//
+// Each chain is collected in one bottom-up pass, and
+// normalized once, so this takes O(n log n) time for a
+// proposition with n nodes.
+Prop const*
+normalize(Prop_factory& f, Prop const* p)
+{
+  struct Fn
+  {
+    Fn(Prop_factory& f)
+      : f(f)
+    { }
+
+    Chain operator()(Atom const* p) const { return Chain{atom_prop, {p}}; }
+    Chain operator()(And const*, Chain l, Chain r) const { return join(and_prop, l, r); }
+    Chain operator()(Or const*, Chain l, Chain r) const { return join(or_prop, l, r); }
+
+    // Negations and implications are not chains; only their
+    // operands are normalized.
+    Chain operator()(Not const*, Chain c) const
+    {
+      return Chain{atom_prop, {f.make_not(finish(f, c))}};
+    }
+
+    Chain operator()(Implies const*, Chain l, Chain r) const
+    {
+      Prop const* p = finish(f, l);
+      return Chain{atom_prop, {f.make_implies(p, finish(f, r))}};
+    }
+
+    Chain join(Prop_kind k, Chain& l, Chain& r) const
+    {
+      Chain c {k, {}};
+      merge(f, c.ops, k, l);
+      merge(f, c.ops, k, r);
+      return c;
+    }
+
+    Prop_factory& f;
+  };
+
+  Chain c = fold<Chain>(p, Fn(f));
+  return finish(f, c);
+}
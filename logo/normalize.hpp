@@ -0,0 +1,13 @@
+
+#ifndef NORMALIZE_HPP
+#define NORMALIZE_HPP
+
+
+struct Prop;
+class Prop_factory;
+
+
+Prop const* normalize(Prop_factory&, Prop const*);
+
+
+#endif
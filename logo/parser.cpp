@@ -2,14 +2,52 @@
 #include "parser.hpp"
 #include "ast.hpp"
 
+#include <vector>
+
 
 // Parse a proposition.
 //
-//    prop -> disjunction
+//    prop -> implication
+//
+// In incremental mode, this discards any previous parse
+// and records the new parse tree.
 Prop const*
 Parser::proposition()
 {
-  return disjunction();
+  if (cache_) {
+    cache_->clear();
+    ++cache_->gen_;
+    try {
+      cache_->root_ = parse(implication_node);
+    } catch (...) {
+      cache_->clear();
+      throw;
+    }
+    return cache_->root_->prop;
+  }
+  return implication();
+}
+
+
+// Parse an implication.
+//
+//    implication -> disjunction '->' implication
+//                 | disjunction
+//
+// Implication is right associative. The operands are
+// collected in a loop and the implications are built from
+// the right, so long chains do not recurse.
+Prop const*
+Parser::implication()
+{
+  std::vector<Prop const*> ops {disjunction()};
+  while (match_if(arrow_tok))
+    ops.push_back(disjunction());
+
+  Prop const* e = ops.back();
+  for (std::size_t i = ops.size() - 1; i-- > 0; )
+    e = on_implication(ops[i], e);
+  return e;
 }
 
 
@@ -35,15 +73,15 @@ Parser::disjunction()
 
 // Parse a conjunction.
 //
-//    conjunction -> conjunction 'and' primary
-//                 | primary
+//    conjunction -> conjunction 'and' negation
+//                 | negation
 Prop const*
 Parser::conjunction()
 {
-  Prop const* e1 = primary();
+  Prop const* e1 = negation();
   while (true) {
     if (match_if(and_tok)) {
-      Prop const* e2 = primary();
+      Prop const* e2 = negation();
       e1 = on_conjunction(e1, e2);
     } else {
       break;
@@ -53,6 +91,26 @@ Parser::conjunction()
 }
 
 
+// Parse a negation.
+//
+//    negation -> 'not' negation
+//              | primary
+//
+// Repeated negations are counted rather than parsed
+// recursively.
+Prop const*
+Parser::negation()
+{
+  std::size_t n = 0;
+  while (match_if(not_tok))
+    ++n;
+  Prop const* e = primary();
+  while (n-- > 0)
+    e = on_negation(e);
+  return e;
+}
+
+
 // Parse a primary proposition.
 //
 //    primary -> identifier
@@ -114,20 +172,34 @@ Parser::accept()
 Prop const*
 Parser::on_identifier(Token tok)
 {
-  return new Atom(tok.symbol());
+  return props_.make_atom(tok.symbol());
+}
+
+
+Prop const*
+Parser::on_negation(Prop const* e)
+{
+  return props_.make_not(e);
 }
 
 
 Prop const*
 Parser::on_conjunction(Prop const* e1, Prop const* e2)
 {
-  return new And(e1, e2);
+  return props_.make_and(e1, e2);
 }
 
 
 Prop const*
 Parser::on_disjunction(Prop const* e1, Prop const* e2)
 {
-  return new Or(e1, e2);
+  return props_.make_or(e1, e2);
+}
+
+
+Prop const*
+Parser::on_implication(Prop const* e1, Prop const* e2)
+{
+  return props_.make_implies(e1, e2);
 }
 
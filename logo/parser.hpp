@@ -4,27 +4,57 @@
 
 #include "string.hpp"
 #include "token.hpp"
+#include "reparse.hpp"
 
 
 struct Prop;
-
-
+class Prop_factory;
+
+
+// The parser transforms a token stream into a proposition.
+// The nodes of the proposition are created by the given
+// factory.
+//
+// When constructed with a parse cache, the parser runs in
+// incremental mode: proposition() records the parse tree
+// in the cache, and after each call to Lexer::relex(),
+// reparse() rebuilds only the part of the tree affected
+// by the edit. Unchanged subtrees are reused, so their
+// propositions keep their identity.
 class Parser
 {
 public:
-  Parser(Token_stream&);
+  Parser(Token_stream&, Prop_factory&);
+  Parser(Token_stream&, Prop_factory&, Parse_cache&);
 
   // Parsers
   Prop const* proposition();
+  Prop const* implication();
   Prop const* disjunction();
   Prop const* conjunction();
+  Prop const* negation();
   Prop const* primary();
 
+  // Incremental parsing
+  Prop const* reparse(Token_edit const&);
+
 private:
+  // Incremental parsers
+  Parse_node* parse(Parse_kind);
+  Parse_node* parse_implication();
+  Parse_node* parse_chain(Parse_kind);
+  Parse_node* parse_primary();
+  Parse_node* parse_step(Parse_kind, Tokenbuf::iterator, Parse_node*, Parse_node*, Parse_node* = nullptr);
+  Parse_node* reuse(Parse_kind);
+  Parse_node* resume(Parse_node*);
+  Token const* current() const;
+
   // Actions
   Prop const* on_identifier(Token);
+  Prop const* on_negation(Prop const*);
   Prop const* on_conjunction(Prop const*, Prop const*);
   Prop const* on_disjunction(Prop const*, Prop const*);
+  Prop const* on_implication(Prop const*, Prop const*);
 
   // Parsing support
   Token lookahead() const;
@@ -34,12 +64,21 @@ private:
 
 private:
   Token_stream& ts_;
+  Prop_factory& props_;  // Creates propositions
+  Parse_cache*  cache_;  // The cache, in incremental mode
+  Damage const* damage_; // The damage, during a reparse
 };
 
 
 inline
-Parser::Parser(Token_stream& t)
-  : ts_(t)
+Parser::Parser(Token_stream& t, Prop_factory& f)
+  : ts_(t), props_(f), cache_(nullptr), damage_(nullptr)
+{ }
+
+
+inline
+Parser::Parser(Token_stream& t, Prop_factory& f, Parse_cache& c)
+  : ts_(t), props_(f), cache_(&c), damage_(nullptr)
 { }
 
 
@@ -0,0 +1,164 @@
+
+#include "pool.hpp"
+
+
+namespace
+{
+
+// The pool and queue of the current thread, if it is a
+// worker.
+thread_local Task_pool const* this_pool = nullptr;
+thread_local unsigned         this_worker = 0;
+
+} // namespace
+
+
+// Run the task, recording any exception it throws.
+void
+Task::run()
+{
+  try {
+    fn_();
+  } catch (...) {
+    error_ = std::current_exception();
+  }
+  done_.store(true, std::memory_order_release);
+}
+
+
+// Construct a pool with n worker threads. At least one
+// worker is created.
+Task_pool::Task_pool(unsigned n)
+  : pending_(0), stop_(false)
+{
+  if (n == 0)
+    n = 1;
+  for (unsigned i = 0; i <= n; ++i)
+    queues_.emplace_back(new Queue());
+  for (unsigned i = 0; i < n; ++i)
+    threads_.emplace_back(&Task_pool::work, this, i);
+}
+
+
+Task_pool::~Task_pool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread& t : threads_)
+    t.join();
+}
+
+
+// Make the task t available to run. The calling thread
+// must later join t.
+void
+Task_pool::fork(Task& t)
+{
+  Queue& q = local();
+  {
+    std::lock_guard<std::mutex> lock(q.mutex);
+    q.tasks.push_back(&t);
+  }
+  ++pending_;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+  }
+  wake_.notify_one();
+}
+
+
+// Wait for the task t to finish, running other tasks in
+// the meantime. If t threw an exception, it is rethrown.
+void
+Task_pool::join(Task& t)
+{
+  Queue& q = local();
+  while (!t.done()) {
+    if (Task* u = find(q))
+      u->run();
+    else
+      std::this_thread::yield();
+  }
+  if (t.error_)
+    std::rethrow_exception(t.error_);
+}
+
+
+// Returns the queue of the calling thread.
+Task_pool::Queue&
+Task_pool::local()
+{
+  if (this_pool == this)
+    return *queues_[this_worker];
+  return *queues_.back();
+}
+
+
+// Take a task from the back of the queue q.
+Task*
+Task_pool::take(Queue& q)
+{
+  std::lock_guard<std::mutex> lock(q.mutex);
+  if (q.tasks.empty())
+    return nullptr;
+  Task* t = q.tasks.back();
+  q.tasks.pop_back();
+  --pending_;
+  return t;
+}
+
+
+// Steal a task from the front of the queue q.
+Task*
+Task_pool::steal(Queue& q)
+{
+  std::lock_guard<std::mutex> lock(q.mutex);
+  if (q.tasks.empty())
+    return nullptr;
+  Task* t = q.tasks.front();
+  q.tasks.pop_front();
+  --pending_;
+  return t;
+}
+
+
+// Find a task to run, first in the queue q, and then
+// in the other queues.
+Task*
+Task_pool::find(Queue& q)
+{
+  if (Task* t = take(q))
+    return t;
+  if (!pending_)
+    return nullptr;
+  for (auto& other : queues_) {
+    if (other.get() != &q) {
+      if (Task* t = steal(*other))
+        return t;
+    }
+  }
+  return nullptr;
+}
+
+
+// The main loop of the worker n.
+void
+Task_pool::work(unsigned n)
+{
+  this_pool = this;
+  this_worker = n;
+  Queue& q = *queues_[n];
+  while (true) {
+    if (Task* t = find(q)) {
+      t->run();
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    wake_.wait(lock, [this]() { return stop_ || pending_ > 0; });
+    if (stop_)
+      return;
+  }
+}
@@ -0,0 +1,112 @@
+
+#ifndef POOL_HPP
+#define POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// -------------------------------------------------------------------------- //
+//                                Tasks
+
+// A task is a unit of work forked onto a task pool. The
+// task is owned by the thread that forks it, and must
+// outlive the call to join() that waits for it.
+class Task
+{
+  friend class Task_pool;
+public:
+  template<typename F>
+  Task(F);
+
+  bool done() const;
+
+private:
+  void run();
+
+  std::function<void()> fn_;   // The work to run
+  std::exception_ptr    error_; // An exception thrown by fn_
+  std::atomic<bool>     done_;  // True when fn_ has returned
+};
+
+
+template<typename F>
+inline
+Task::Task(F fn)
+  : fn_(fn), done_(false)
+{ }
+
+
+// Returns true if the task has finished.
+inline bool
+Task::done() const
+{
+  return done_.load(std::memory_order_acquire);
+}
+
+
+// -------------------------------------------------------------------------- //
+//                              Task pool
+
+// The task pool runs forked tasks on a set of worker
+// threads by work stealing.
+//
+// Each worker has a queue of tasks. A thread pushes the
+// tasks it forks onto the back of its own queue, and takes
+// them back from the back; an idle worker steals from the
+// front of another queue. A thread that waits in join()
+// runs other tasks until the one it waits for is done, so
+// fork and join may be nested freely. Threads that are not
+// workers of the pool share one extra queue.
+class Task_pool
+{
+public:
+  Task_pool(unsigned = std::thread::hardware_concurrency());
+  ~Task_pool();
+
+  Task_pool(Task_pool const&) = delete;
+  Task_pool& operator=(Task_pool const&) = delete;
+
+  unsigned size() const;
+
+  void fork(Task&);
+  void join(Task&);
+
+private:
+  struct Queue
+  {
+    std::mutex        mutex;
+    std::deque<Task*> tasks;
+  };
+
+  Queue& local();
+  Task*  take(Queue&);
+  Task*  steal(Queue&);
+  Task*  find(Queue&);
+  void   work(unsigned);
+
+  std::vector<std::unique_ptr<Queue>> queues_;  // Queues; the last is shared
+  std::vector<std::thread>            threads_; // Worker threads
+  std::mutex                          mutex_;   // Guards sleeping
+  std::condition_variable             wake_;    // Signals new tasks
+  std::atomic<std::size_t>            pending_; // Tasks in queues
+  bool                                stop_;    // True when shutting down
+};
+
+
+// Returns the number of worker threads.
+inline unsigned
+Task_pool::size() const
+{
+  return threads_.size();
+}
+
+
+#endif
@@ -0,0 +1,396 @@
+
+#include "reparse.hpp"
+#include "parser.hpp"
+#include "ast.hpp"
+
+#include <iterator>
+#include <vector>
+
+
+// -------------------------------------------------------------------------- //
+//                              Damage
+
+Damage::Damage(Tokenbuf& buf, Token_edit const& e)
+  : buf_(buf)
+  , prev_(buf.end())
+  , next_(e.last)
+  , removed_()
+  , empty_(e.first == e.last && e.removed.empty())
+{
+  if (e.first != buf.begin())
+    prev_ = std::prev(e.first);
+  for (Token const& tok : e.removed)
+    removed_.insert(&tok);
+}
+
+
+// Returns true if the token was replaced by the edit.
+inline bool
+Damage::removed(Tokenbuf::iterator i) const
+{
+  return i != buf_.end() && removed_.count(&*i);
+}
+
+
+// Returns true if the (unremoved) token lies before the
+// edit. Tokens before the edit keep their offsets, and
+// those after it are shifted past the new tokens, so
+// offsets can be compared directly.
+inline bool
+Damage::before(Tokenbuf::iterator i) const
+{
+  return prev_ != buf_.end()
+      && i != buf_.end()
+      && i->offset() <= prev_->offset();
+}
+
+
+// Returns true if the (unremoved) token lies after the
+// edit. The end of the buffer is after every edit.
+inline bool
+Damage::after(Tokenbuf::iterator i) const
+{
+  if (i == buf_.end())
+    return true;
+  return next_ != buf_.end() && i->offset() >= next_->offset();
+}
+
+
+// Returns true if the tokens recorded by the parse node
+// were changed by the edit.
+bool
+Damage::affects(Parse_node const* n) const
+{
+  if (empty_)
+    return false;
+  if (removed(n->first) || removed(n->last))
+    return true;
+  return before(n->first) && after(n->last);
+}
+
+
+// -------------------------------------------------------------------------- //
+//                              Parse cache
+
+// Returns the node recorded for production k at the
+// token t, if any.
+Parse_node*
+Parse_cache::find(Parse_kind k, Token const* t) const
+{
+  if (t == nullptr)
+    return nullptr;
+  auto iter = nodes_[k].find(t);
+  if (iter != nodes_[k].end())
+    return iter->second;
+  return nullptr;
+}
+
+
+// Allocate a new node for production k starting at the
+// token i.
+Parse_node*
+Parse_cache::make(Parse_kind k, Tokenbuf::iterator i)
+{
+  Parse_node* n = new Parse_node{k, i, i, nullptr, nullptr, nullptr, gen_};
+  all_.insert(n);
+  return n;
+}
+
+
+// Make the node n available for reuse.
+void
+Parse_cache::index(Parse_node* n)
+{
+  nodes_[n->kind][&*n->first] = n;
+}
+
+
+// Release the node n.
+void
+Parse_cache::destroy(Parse_node* n)
+{
+  auto iter = nodes_[n->kind].find(&*n->first);
+  if (iter != nodes_[n->kind].end() && iter->second == n)
+    nodes_[n->kind].erase(iter);
+  all_.erase(n);
+  delete n;
+}
+
+
+// Release the parts of the old tree n that are not part
+// of the current tree. Nodes of the current parse have
+// the current generation, and we don't look inside them.
+//
+// Note that this must be called while any tokens removed
+// by the edit are still alive.
+void
+Parse_cache::discard(Parse_node* n)
+{
+  std::vector<Parse_node*> stack {n};
+  while (!stack.empty()) {
+    Parse_node* n = stack.back();
+    stack.pop_back();
+    if (n->gen == gen_)
+      continue;
+    if (n->left)
+      stack.push_back(n->left);
+    if (n->right)
+      stack.push_back(n->right);
+    destroy(n);
+  }
+}
+
+
+// Release all nodes.
+void
+Parse_cache::clear()
+{
+  for (Parse_node* n : all_)
+    delete n;
+  all_.clear();
+  for (Node_map& m : nodes_)
+    m.clear();
+  root_ = nullptr;
+}
+
+
+// -------------------------------------------------------------------------- //
+//                          Incremental parsing
+
+// Update the proposition after the tokens in the stream
+// have been changed by the edit e. Nodes that do not
+// cover the edit are reused, and only the nodes
+// enclosing it are parsed again.
+//
+// Note that reparse() must be called after each edit,
+// while e is still alive. If parsing fails, the cache is
+// cleared and the exception is propagated.
+Prop const*
+Parser::reparse(Token_edit const& e)
+{
+  assert(cache_);
+
+  Damage damage(ts_.buffer(), e);
+  damage_ = &damage;
+  ++cache_->gen_;
+  ts_.rewind();
+  try {
+    Parse_node* old = cache_->root_;
+    Parse_node* n = parse(implication_node);
+    cache_->root_ = n;
+    if (old)
+      cache_->discard(old);
+  } catch (...) {
+    damage_ = nullptr;
+    cache_->clear();
+    throw;
+  }
+  damage_ = nullptr;
+  return cache_->root_->prop;
+}
+
+
+// Parse the production k, recording the parse tree.
+Parse_node*
+Parser::parse(Parse_kind k)
+{
+  if (k == primary_node)
+    return parse_primary();
+  else if (k == implication_node)
+    return parse_implication();
+  else
+    return parse_chain(k);
+}
+
+
+// Parse an implication.
+//
+// Operands are parsed until an undamaged implication is
+// found at the current token, which covers the rest of the
+// sequence and is reused as a whole. Then the new nodes
+// are built from the right.
+Parse_node*
+Parser::parse_implication()
+{
+  struct Step
+  {
+    Tokenbuf::iterator first;
+    Parse_node*        op;
+  };
+
+  std::vector<Step> steps;
+  Parse_node* n = nullptr;
+  while (true) {
+    Tokenbuf::iterator first = ts_.position();
+    if ((n = reuse(implication_node)))
+      break;
+    steps.push_back({first, parse(disjunction_node)});
+    if (!match_if(arrow_tok))
+      break;
+  }
+
+  Tokenbuf::iterator last = ts_.position();
+  while (!steps.empty()) {
+    Step& s = steps.back();
+    Parse_node* m = cache_->make(implication_node, s.first);
+    m->left = s.op;
+    m->right = n;
+    m->last = last;
+    m->prop = n ? on_implication(s.op->prop, n->prop) : s.op->prop;
+    cache_->index(m);
+    n = m;
+    steps.pop_back();
+  }
+  return n;
+}
+
+
+// Parse a disjunction or conjunction.
+//
+// If the chain starting at this token was damaged, the
+// longest prefix of its operands that precedes the edit
+// is kept, and parsing resumes after it. For each new
+// step, if the old chain had a step with the same left
+// and right propositions, its proposition is reused.
+Parse_node*
+Parser::parse_chain(Parse_kind k)
+{
+  Tokenbuf::iterator first = ts_.position();
+  if (Parse_node* n = reuse(k))
+    return n;
+
+  Parse_kind sub = k == disjunction_node ? conjunction_node : primary_node;
+  Token_kind op = k == disjunction_node ? or_tok : and_tok;
+
+  // Find the unchanged prefix of the old chain, if any.
+  // The damaged steps above it are candidates for reuse.
+  std::vector<Parse_node*> spine;
+  Parse_node* n = cache_->find(k, current());
+  while (n && damage_->affects(n)) {
+    spine.push_back(n);
+    n = n->left;
+  }
+
+  if (n)
+    resume(n);
+  else
+    n = parse_step(k, first, nullptr, parse(sub));
+  while (match_if(op)) {
+    Parse_node* old = spine.empty() ? nullptr : spine.back();
+    n = parse_step(k, first, n, parse(sub), old);
+    if (!spine.empty())
+      spine.pop_back();
+  }
+
+  cache_->index(n);
+  return n;
+}
+
+
+// Record a step of the chain k that extends the node n1 with
+// the operand n2. If the old step has the same
+// propositions as operands, its proposition is reused.
+Parse_node*
+Parser::parse_step(Parse_kind k, Tokenbuf::iterator first, Parse_node* n1, Parse_node* n2, Parse_node* old)
+{
+  Parse_node* n = cache_->make(k, first);
+  n->left = n1;
+  n->right = n2;
+  n->last = ts_.position();
+  if (!n1)
+    n->prop = n2->prop;
+  else if (old && old->left && old->left->prop == n1->prop && old->right->prop == n2->prop)
+    n->prop = old->prop;
+  else if (k == disjunction_node)
+    n->prop = on_disjunction(n1->prop, n2->prop);
+  else
+    n->prop = on_conjunction(n1->prop, n2->prop);
+  return n;
+}
+
+
+// Parse a primary or negation, recording the parse tree.
+//
+// Leading 'not' tokens are collected in a loop, until an
+// undamaged primary is found or a primary is parsed. Then
+// a node is built for each negation, from the inside out.
+Parse_node*
+Parser::parse_primary()
+{
+  std::vector<Tokenbuf::iterator> nots;
+  Parse_node* n;
+  while (true) {
+    Tokenbuf::iterator first = ts_.position();
+    if ((n = reuse(primary_node)))
+      break;
+    if (match_if(not_tok)) {
+      nots.push_back(first);
+      continue;
+    }
+
+    n = cache_->make(primary_node, first);
+    if (Token tok = match_if(identifier_tok)) {
+      n->prop = on_identifier(tok);
+    } else if (match_if(lparen_tok)) {
+      n->right = parse(implication_node);
+      n->prop = n->right->prop;
+      match(rparen_tok);
+    } else {
+      throw std::runtime_error("syntax error");
+    }
+    n->last = std::prev(ts_.position());
+    cache_->index(n);
+    break;
+  }
+
+  while (!nots.empty()) {
+    Parse_node* m = cache_->make(primary_node, nots.back());
+    m->right = n;
+    m->last = n->last;
+    m->prop = on_negation(n->prop);
+    cache_->index(m);
+    n = m;
+    nots.pop_back();
+  }
+  return n;
+}
+
+
+// If the node for production k at the current token was
+// not damaged, skip its tokens and return it. Otherwise,
+// return nullptr.
+Parse_node*
+Parser::reuse(Parse_kind k)
+{
+  if (!damage_)
+    return nullptr;
+  Parse_node* n = cache_->find(k, current());
+  if (!n || damage_->affects(n))
+    return nullptr;
+  return resume(n);
+}
+
+
+// Returns the current token, or nullptr at the end of
+// the stream.
+Token const*
+Parser::current() const
+{
+  if (ts_.eof())
+    return nullptr;
+  return &*ts_.position();
+}
+
+
+// Mark the node n as part of the current parse and
+// move the stream past its tokens.
+Parse_node*
+Parser::resume(Parse_node* n)
+{
+  n->gen = cache_->gen_;
+  if (n->kind == primary_node)
+    ts_.seek(std::next(n->last));
+  else
+    ts_.seek(n->last);
+  return n;
+}
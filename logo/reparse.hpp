@@ -0,0 +1,164 @@
+#ifndef REPARSE_HPP
+#define REPARSE_HPP
+
+#include "token.hpp"
+
+#include <unordered_map>
+#include <unordered_set>
+
+
+struct Prop;
+
+
+// -------------------------------------------------------------------------- //
+//                              Parse nodes
+
+// The productions recorded in incremental mode.
+enum Parse_kind
+{
+  implication_node,
+  disjunction_node,
+  conjunction_node,
+  primary_node,
+};
+
+
+// A parse node records the tokens matched by a production
+// and the proposition it produced.
+//
+// For a primary, the tokens [first, last] were consumed.
+// A chain also examines the token following its operands,
+// so last is that token of lookahead, and only [first,
+// last) were consumed. Note that the lookahead may be the
+// end of the token buffer.
+//
+// A chain of operands (a disjunction or conjunction) is
+// recorded as a left-nested sequence of steps. Each step
+// covers the operands parsed so far: left is the previous
+// step, right is the operand, and prop is the proposition
+// built from both. This lets a reparse reuse the longest
+// unchanged prefix of a chain in one step. For a primary,
+// right is the enclosed implication, if any.
+//
+// Implication is right associative, so an implication is
+// recorded as a right-nested sequence instead: left is its
+// first operand (a disjunction), and right is the
+// implication that follows the arrow, if any. Every node
+// of the sequence ends at the same lookahead, so a reparse
+// can reuse the longest unchanged suffix in one step.
+//
+// A negation is recorded as a primary whose right is its
+// operand, another primary.
+struct Parse_node
+{
+  Parse_kind         kind;
+  Tokenbuf::iterator first;
+  Tokenbuf::iterator last;
+  Prop const*        prop;
+  Parse_node*        left;
+  Parse_node*        right;
+  unsigned           gen;
+};
+
+
+// -------------------------------------------------------------------------- //
+//                              Damage
+
+// The damage describes the tokens changed by an edit, and
+// determines which recorded nodes can no longer be reused.
+//
+// In the token buffer, the tokens of the edit lie between
+// prev (the last unchanged token before the edit) and next
+// (the first unchanged token after it). A node is damaged
+// if it covers a removed token or spans the edit.
+class Damage
+{
+public:
+  Damage(Tokenbuf&, Token_edit const&);
+
+  bool affects(Parse_node const*) const;
+
+private:
+  bool removed(Tokenbuf::iterator) const;
+  bool before(Tokenbuf::iterator) const;
+  bool after(Tokenbuf::iterator) const;
+
+  Tokenbuf&                         buf_;
+  Tokenbuf::iterator                prev_;    // Last token before
+  Tokenbuf::iterator                next_;    // First token after
+  std::unordered_set<Token const*>  removed_; // Replaced tokens
+  bool                              empty_;   // True if no change
+};
+
+
+// -------------------------------------------------------------------------- //
+//                              Parse cache
+
+// The parse cache holds the parse tree of the last parse
+// in incremental mode. Nodes are indexed by production and
+// first token so that a reparse can find them again.
+//
+// Every indexed node belongs to the current tree. Nodes
+// that are not reused by a reparse are discarded when
+// the reparse completes.
+class Parse_cache
+{
+  friend class Parser;
+public:
+  Parse_cache();
+  ~Parse_cache();
+
+  Parse_cache(Parse_cache const&) = delete;
+  Parse_cache& operator=(Parse_cache const&) = delete;
+
+  Parse_node const* root() const;
+  std::size_t       size() const;
+
+  void clear();
+
+private:
+  using Node_map = std::unordered_map<Token const*, Parse_node*>;
+
+  Parse_node* find(Parse_kind, Token const*) const;
+  Parse_node* make(Parse_kind, Tokenbuf::iterator);
+  void        index(Parse_node*);
+  void        discard(Parse_node*);
+  void        destroy(Parse_node*);
+
+  Node_map                        nodes_[4]; // Indexed nodes
+  std::unordered_set<Parse_node*> all_;      // Allocated nodes
+  Parse_node*                     root_;     // The current tree
+  unsigned                        gen_;      // Current generation
+};
+
+
+inline
+Parse_cache::Parse_cache()
+  : root_(nullptr), gen_(0)
+{ }
+
+
+inline
+Parse_cache::~Parse_cache()
+{
+  clear();
+}
+
+
+// Returns the root of the current parse tree.
+inline Parse_node const*
+Parse_cache::root() const
+{
+  return root_;
+}
+
+
+// Returns the number of nodes in the cache.
+inline std::size_t
+Parse_cache::size() const
+{
+  return all_.size();
+}
+
+
+#endif
@@ -0,0 +1,687 @@
+
+#include "sat.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+
+
+constexpr Sat_solver::Lit Sat_solver::no_lit;
+constexpr Sat_solver::Ref Sat_solver::no_clause;
+
+
+namespace
+{
+
+// Parameters of the search.
+constexpr double var_decay     = 0.95;
+constexpr float  cla_decay     = 0.999f;
+constexpr int    restart_unit  = 100;
+constexpr double learnt_growth = 1.1;
+
+// Each clause is stored in the clause memory as a header
+// of three words followed by its literals. The header
+// holds the size, whether the clause is learnt, and its
+// activity (or, while the memory is compacted, its new
+// offset).
+constexpr std::uint32_t header_size = 3;
+
+
+// Returns the i-th element of the Luby sequence
+// 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8, ...
+std::uint64_t
+luby(std::uint64_t i)
+{
+  std::uint64_t size = 1, seq = 0;
+  while (size < i + 1) {
+    ++seq;
+    size = 2 * size + 1;
+  }
+  while (size - 1 != i) {
+    size = (size - 1) / 2;
+    --seq;
+    i = i % size;
+  }
+  return std::uint64_t(1) << seq;
+}
+
+} // namespace
+
+
+Sat_solver::Sat_solver()
+  : head_(0)
+  , var_inc_(1)
+  , cla_inc_(1)
+  , max_learnts_(0)
+  , ok_(true)
+  , decisions_(0)
+  , propagations_(0)
+  , conflicts_(0)
+  , restarts_(0)
+{ }
+
+
+// Prepare for the given number of variables and clauses.
+void
+Sat_solver::header(std::uint32_t vars, std::uint64_t clauses)
+{
+  while (variables() < vars)
+    new_var();
+  clauses_.reserve(clauses);
+}
+
+
+// Returns a new variable.
+int
+Sat_solver::new_var()
+{
+  if (variables() >= std::uint32_t(INT_MAX))
+    throw std::length_error("too many variables");
+  std::uint32_t v = variables();
+  assigns_.push_back(0);
+  levels_.push_back(0);
+  reasons_.push_back(no_clause);
+  phases_.push_back(0);
+  seen_.push_back(0);
+  acts_.push_back(0);
+  places_.push_back(-1);
+  watches_.emplace_back();
+  watches_.emplace_back();
+  heap_insert(v);
+  return v + 1;
+}
+
+
+// Add a clause. Duplicate literals are removed, and a
+// clause that is always true is ignored. Clauses may only
+// be added while the solver is not searching.
+void
+Sat_solver::clause(int const* ls, std::size_t n)
+{
+  if (!ok_)
+    return;
+
+  std::vector<Lit> c;
+  for (std::size_t i = 0; i < n; ++i) {
+    int x = ls[i];
+    if (x == 0 || x == INT_MIN)
+      throw std::invalid_argument("invalid literal");
+    std::uint32_t v = (x < 0 ? -x : x) - 1;
+    while (v >= variables())
+      new_var();
+    c.push_back(2 * v + (x < 0));
+  }
+  std::sort(c.begin(), c.end());
+  c.erase(std::unique(c.begin(), c.end()), c.end());
+
+  // Drop false literals, and ignore satisfied clauses and
+  // tautologies.
+  std::size_t k = 0;
+  for (std::size_t i = 0; i < c.size(); ++i) {
+    if (truth(c[i]) > 0 || (i > 0 && c[i] == (c[i - 1] ^ 1)))
+      return;
+    if (truth(c[i]) == 0)
+      c[k++] = c[i];
+  }
+  c.resize(k);
+
+  if (c.empty()) {
+    ok_ = false;
+  } else if (c.size() == 1) {
+    assign(c[0], no_clause);
+    ok_ = propagate() == no_clause;
+  } else {
+    Ref r = alloc(c, false);
+    clauses_.push_back(r);
+    attach(r);
+  }
+}
+
+
+// Returns the value of the variable of x in the model
+// found by the last call to solve().
+bool
+Sat_solver::value(int x) const
+{
+  std::uint32_t v = (x < 0 ? -x : x) - 1;
+  assert(v < model_.size());
+  return model_[v] != (x < 0);
+}
+
+
+// -------------------------------------------------------------------------- //
+//                              Values
+
+// Returns 1 if p is true, -1 if it is false, and 0 if it
+// is unassigned.
+inline int
+Sat_solver::truth(Lit p) const
+{
+  int a = assigns_[p >> 1];
+  return p & 1 ? -a : a;
+}
+
+
+// Returns the current decision level.
+inline int
+Sat_solver::level() const
+{
+  return limits_.size();
+}
+
+
+// Make p true, with the given reason.
+inline void
+Sat_solver::assign(Lit p, Ref r)
+{
+  std::uint32_t v = p >> 1;
+  assigns_[v] = p & 1 ? -1 : 1;
+  levels_[v] = level();
+  reasons_[v] = r;
+  trail_.push_back(p);
+}
+
+
+// Undo the assignments above the level n, saving the
+// phase of each variable.
+void
+Sat_solver::backtrack(int n)
+{
+  if (level() <= n)
+    return;
+  for (std::size_t i = trail_.size(); i-- > limits_[n]; ) {
+    std::uint32_t v = trail_[i] >> 1;
+    phases_[v] = trail_[i] & 1;
+    assigns_[v] = 0;
+    reasons_[v] = no_clause;
+    heap_insert(v);
+  }
+  trail_.resize(limits_[n]);
+  head_ = trail_.size();
+  limits_.resize(n);
+}
+
+
+// -------------------------------------------------------------------------- //
+//                              Clauses
+
+// Store a clause with the literals c, and return its
+// reference.
+Sat_solver::Ref
+Sat_solver::alloc(std::vector<Lit> const& c, bool learnt)
+{
+  if (mem_.size() + header_size + c.size() >= no_clause)
+    throw std::length_error("too many clauses");
+  Ref r = mem_.size();
+  mem_.push_back(c.size());
+  mem_.push_back(learnt);
+  mem_.push_back(0);
+  mem_.insert(mem_.end(), c.begin(), c.end());
+  return r;
+}
+
+
+inline std::uint32_t
+Sat_solver::size(Ref r) const
+{
+  return mem_[r];
+}
+
+
+inline Sat_solver::Lit*
+Sat_solver::lits(Ref r)
+{
+  return &mem_[r + header_size];
+}
+
+
+inline bool
+Sat_solver::learnt(Ref r) const
+{
+  return mem_[r + 1];
+}
+
+
+inline float
+Sat_solver::activity(Ref r) const
+{
+  static_assert(sizeof(float) == sizeof(std::uint32_t), "unexpected float size");
+  float a;
+  std::memcpy(&a, &mem_[r + 2], sizeof(a));
+  return a;
+}
+
+
+inline void
+Sat_solver::set_activity(Ref r, float a)
+{
+  std::memcpy(&mem_[r + 2], &a, sizeof(a));
+}
+
+
+// Returns true if the clause r is the reason for an
+// assignment. The implied literal is always the first.
+inline bool
+Sat_solver::locked(Ref r)
+{
+  Lit p = lits(r)[0];
+  return truth(p) > 0 && reasons_[p >> 1] == r;
+}
+
+
+// Watch the first two literals of the clause r.
+inline void
+Sat_solver::attach(Ref r)
+{
+  Lit* c = lits(r);
+  watches_[c[0] ^ 1].push_back({r, c[1]});
+  watches_[c[1] ^ 1].push_back({r, c[0]});
+}
+
+
+// Remove the less active half of the learnt clauses,
+// except those that are reasons and binary clauses.
+void
+Sat_solver::reduce()
+{
+  std::sort(learnts_.begin(), learnts_.end(), [this](Ref a, Ref b) {
+    return activity(a) < activity(b);
+  });
+  std::size_t half = learnts_.size() / 2;
+  std::size_t k = 0;
+  for (std::size_t i = 0; i < learnts_.size(); ++i) {
+    Ref r = learnts_[i];
+    if (i >= half || size(r) <= 2 || locked(r))
+      learnts_[k++] = r;
+  }
+  learnts_.resize(k);
+  collect();
+}
+
+
+// Compact the clause memory, keeping only the clauses in
+// the lists, and rebuild the watches. Each moved clause
+// records its new offset, which is used to update the
+// reasons.
+void
+Sat_solver::collect()
+{
+  std::vector<std::uint32_t> mem;
+  mem.reserve(mem_.size());
+  auto move = [&](Ref& r) {
+    Ref n = mem.size();
+    mem.insert(mem.end(), &mem_[r], &mem_[r] + header_size + size(r));
+    mem_[r + 2] = n;
+    r = n;
+  };
+  for (Ref& r : clauses_)
+    move(r);
+  for (Ref& r : learnts_)
+    move(r);
+  for (Lit p : trail_) {
+    Ref& r = reasons_[p >> 1];
+    if (r != no_clause)
+      r = mem_[r + 2];
+  }
+  mem_.swap(mem);
+
+  for (std::vector<Watch>& ws : watches_)
+    ws.clear();
+  for (Ref r : clauses_)
+    attach(r);
+  for (Ref r : learnts_)
+    attach(r);
+}
+
+
+// -------------------------------------------------------------------------- //
+//                              Search
+
+// Propagate the assigned literals that have not been
+// propagated. Returns a conflicting clause, or no_clause.
+//
+// When p becomes true, each clause watching its negation
+// looks for another literal to watch. If there is none,
+// the clause is unit (and its other watched literal is
+// implied) or conflicting.
+Sat_solver::Ref
+Sat_solver::propagate()
+{
+  Ref conflict = no_clause;
+  while (head_ < trail_.size()) {
+    Lit p = trail_[head_++];
+    Lit f = p ^ 1;
+    std::vector<Watch>& ws = watches_[p];
+    ++propagations_;
+
+    Watch* i = ws.data();
+    Watch* j = i;
+    Watch* end = i + ws.size();
+    while (i != end) {
+      if (truth(i->blocker) > 0) {
+        *j++ = *i++;
+        continue;
+      }
+
+      // Make the false literal the second.
+      Ref r = i->ref;
+      Lit* c = lits(r);
+      if (c[0] == f)
+        std::swap(c[0], c[1]);
+      ++i;
+
+      // The clause is satisfied by its first literal.
+      Watch w {r, c[0]};
+      if (truth(c[0]) > 0) {
+        *j++ = w;
+        continue;
+      }
+
+      // Look for a new literal to watch.
+      std::uint32_t n = size(r);
+      bool moved = false;
+      for (std::uint32_t k = 2; k < n; ++k) {
+        if (truth(c[k]) >= 0) {
+          std::swap(c[1], c[k]);
+          watches_[c[1] ^ 1].push_back(w);
+          moved = true;
+          break;
+        }
+      }
+      if (moved)
+        continue;
+
+      // The clause is unit or conflicting.
+      *j++ = w;
+      if (truth(c[0]) < 0) {
+        conflict = r;
+        head_ = trail_.size();
+        while (i != end)
+          *j++ = *i++;
+      } else {
+        assign(c[0], r);
+      }
+    }
+    ws.resize(j - ws.data());
+  }
+  return conflict;
+}
+
+
+// Analyze the conflicting clause r, producing a learnt
+// clause and the level to backtrack to.
+//
+// Literals of the conflict are resolved with their reasons,
+// in reverse order of assignment, until one literal of the
+// current level remains (the first unique implication
+// point). Its negation is the first literal of the learnt
+// clause, and the literal of the highest other level is
+// second, so both can be watched.
+void
+Sat_solver::analyze(Ref r, std::vector<Lit>& out, int& back)
+{
+  out.assign(1, no_lit);
+  int paths = 0;
+  Lit p = no_lit;
+  std::size_t index = trail_.size();
+  do {
+    if (learnt(r))
+      bump_clause(r);
+    Lit* c = lits(r);
+    for (std::uint32_t k = (p == no_lit ? 0 : 1); k < size(r); ++k) {
+      std::uint32_t v = c[k] >> 1;
+      if (seen_[v] || levels_[v] == 0)
+        continue;
+      bump_var(v);
+      seen_[v] = 1;
+      if (levels_[v] >= level())
+        ++paths;
+      else
+        out.push_back(c[k]);
+    }
+
+    // Select the next literal of the conflict.
+    while (!seen_[trail_[--index] >> 1])
+      ;
+    p = trail_[index];
+    r = reasons_[p >> 1];
+    seen_[p >> 1] = 0;
+    --paths;
+  } while (paths > 0);
+  out[0] = p ^ 1;
+
+  // Remove literals implied by the others.
+  std::vector<Lit> marked(out.begin() + 1, out.end());
+  std::size_t k = 1;
+  for (std::size_t i = 1; i < out.size(); ++i) {
+    if (!redundant(out[i]))
+      out[k++] = out[i];
+  }
+  out.resize(k);
+  for (Lit q : marked)
+    seen_[q >> 1] = 0;
+
+  // Find the backtrack level.
+  back = 0;
+  if (out.size() > 1) {
+    std::size_t m = 1;
+    for (std::size_t i = 2; i < out.size(); ++i) {
+      if (levels_[out[i] >> 1] > levels_[out[m] >> 1])
+        m = i;
+    }
+    std::swap(out[1], out[m]);
+    back = levels_[out[1] >> 1];
+  }
+}
+
+
+// Returns true if the literal q of a learnt clause is
+// implied by the other literals, because every other
+// literal of its reason is in the clause.
+inline bool
+Sat_solver::redundant(Lit q)
+{
+  Ref r = reasons_[q >> 1];
+  if (r == no_clause)
+    return false;
+  Lit* c = lits(r);
+  for (std::uint32_t k = 1; k < size(r); ++k) {
+    std::uint32_t v = c[k] >> 1;
+    if (!seen_[v] && levels_[v] > 0)
+      return false;
+  }
+  return true;
+}
+
+
+// Returns the next decision: the most active unassigned
+// variable, with its saved phase. Returns no_lit if every
+// variable is assigned.
+Sat_solver::Lit
+Sat_solver::decide()
+{
+  while (!heap_.empty()) {
+    std::uint32_t v = heap_pop();
+    if (assigns_[v] == 0)
+      return 2 * v + phases_[v];
+  }
+  return no_lit;
+}
+
+
+// Search for a model until the given number of conflicts
+// is reached.
+Sat_solver::Result
+Sat_solver::search(std::uint64_t budget)
+{
+  std::vector<Lit> clause;
+  std::uint64_t n = 0;
+  while (true) {
+    Ref r = propagate();
+    if (r != no_clause) {
+      ++conflicts_;
+      ++n;
+      if (level() == 0)
+        return unsat;
+
+      int back;
+      analyze(r, clause, back);
+      backtrack(back);
+      if (clause.size() == 1) {
+        assign(clause[0], no_clause);
+      } else {
+        Ref c = alloc(clause, true);
+        learnts_.push_back(c);
+        attach(c);
+        bump_clause(c);
+        assign(clause[0], c);
+      }
+      var_inc_ /= var_decay;
+      cla_inc_ /= cla_decay;
+      continue;
+    }
+
+    if (n >= budget) {
+      backtrack(0);
+      return unknown;
+    }
+    if (learnts_.size() >= max_learnts_ + trail_.size())
+      reduce();
+
+    Lit p = decide();
+    if (p == no_lit)
+      return sat;
+    ++decisions_;
+    limits_.push_back(trail_.size());
+    assign(p, no_clause);
+  }
+}
+
+
+// Returns true if the clauses are satisfiable. If so, the
+// model can be queried with value().
+bool
+Sat_solver::solve()
+{
+  model_.clear();
+  if (!ok_)
+    return false;
+
+  max_learnts_ = std::max<double>(clauses_.size() / 3.0, 1000);
+  Result res = unknown;
+  for (std::uint64_t i = 0; res == unknown; ++i) {
+    res = search(luby(i) * restart_unit);
+    if (res == unknown)
+      ++restarts_;
+    max_learnts_ *= learnt_growth;
+  }
+
+  if (res == sat) {
+    model_.resize(variables());
+    for (std::uint32_t v = 0; v < variables(); ++v)
+      model_[v] = assigns_[v] > 0;
+  } else {
+    ok_ = false;
+  }
+  backtrack(0);
+  return res == sat;
+}
+
+
+// -------------------------------------------------------------------------- //
+//                              Heuristics
+
+// Increase the activity of the variable v.
+void
+Sat_solver::bump_var(std::uint32_t v)
+{
+  if ((acts_[v] += var_inc_) > 1e100) {
+    for (double& a : acts_)
+      a *= 1e-100;
+    var_inc_ *= 1e-100;
+  }
+  if (places_[v] >= 0)
+    heap_up(places_[v]);
+}
+
+
+// Increase the activity of the learnt clause r.
+void
+Sat_solver::bump_clause(Ref r)
+{
+  set_activity(r, activity(r) + cla_inc_);
+  if (activity(r) > 1e20f) {
+    for (Ref c : learnts_)
+      set_activity(c, activity(c) * 1e-20f);
+    cla_inc_ *= 1e-20f;
+  }
+}
+
+
+// Add v to the heap, if it is not there.
+void
+Sat_solver::heap_insert(std::uint32_t v)
+{
+  if (places_[v] >= 0)
+    return;
+  places_[v] = heap_.size();
+  heap_.push_back(v);
+  heap_up(heap_.size() - 1);
+}
+
+
+// Move the variable at position i toward the root.
+void
+Sat_solver::heap_up(std::uint32_t i)
+{
+  std::uint32_t v = heap_[i];
+  while (i > 0) {
+    std::uint32_t p = (i - 1) / 2;
+    if (acts_[heap_[p]] >= acts_[v])
+      break;
+    heap_[i] = heap_[p];
+    places_[heap_[i]] = i;
+    i = p;
+  }
+  heap_[i] = v;
+  places_[v] = i;
+}
+
+
+// Move the variable at position i toward the leaves.
+void
+Sat_solver::heap_down(std::uint32_t i)
+{
+  std::uint32_t v = heap_[i];
+  std::uint32_t n = heap_.size();
+  while (2 * i + 1 < n) {
+    std::uint32_t c = 2 * i + 1;
+    if (c + 1 < n && acts_[heap_[c + 1]] > acts_[heap_[c]])
+      ++c;
+    if (acts_[heap_[c]] <= acts_[v])
+      break;
+    heap_[i] = heap_[c];
+    places_[heap_[i]] = i;
+    i = c;
+  }
+  heap_[i] = v;
+  places_[v] = i;
+}
+
+
+// Remove and return the most active variable.
+std::uint32_t
+Sat_solver::heap_pop()
+{
+  std::uint32_t v = heap_[0];
+  places_[v] = -1;
+  heap_[0] = heap_.back();
+  heap_.pop_back();
+  if (!heap_.empty()) {
+    places_[heap_[0]] = 0;
+    heap_down(0);
+  }
+  return v;
+}
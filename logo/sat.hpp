@@ -0,0 +1,168 @@
+#ifndef SAT_HPP
+#define SAT_HPP
+
+#include "cnf.hpp"
+
+#include <cstdint>
+#include <vector>
+
+
+// -------------------------------------------------------------------------- //
+//                              SAT solver
+
+// A conflict-driven clause learning (CDCL) SAT solver.
+//
+// Clauses are added through the Clause_sink interface, so
+// a CNF encoding can be delivered to the solver directly.
+// Literals are DIMACS integers, and variables are created
+// as they are mentioned. Then solve() decides whether the
+// clauses are satisfiable, and value() gives the model.
+//
+// The solver follows the design of MiniSat: two watched
+// literals per clause for unit propagation, first-UIP
+// conflict analysis with clause minimization, VSIDS
+// decisions with phase saving, Luby restarts, and periodic
+// removal of inactive learnt clauses.
+class Sat_solver : public Clause_sink
+{
+public:
+  Sat_solver();
+
+  void header(std::uint32_t, std::uint64_t);
+  void clause(int const*, std::size_t);
+
+  int           new_var();
+  std::uint32_t variables() const;
+
+  bool solve();
+  bool value(int) const;
+
+  // Statistics
+  std::uint64_t decisions() const;
+  std::uint64_t propagations() const;
+  std::uint64_t conflicts() const;
+  std::uint64_t restarts() const;
+
+private:
+  using Lit = std::uint32_t; // 2 * var + 1 if negative
+  using Ref = std::uint32_t; // Offset of a clause
+
+  static constexpr Lit no_lit = -1;
+  static constexpr Ref no_clause = -1;
+
+  // A clause that watches the negation of a literal,
+  // with one of its other literals. If the blocker is
+  // true, the clause is satisfied and is not visited.
+  struct Watch
+  {
+    Ref ref;
+    Lit blocker;
+  };
+
+  enum Result { sat, unsat, unknown };
+
+  // Values
+  int  truth(Lit) const;
+  int  level() const;
+  void assign(Lit, Ref);
+  void backtrack(int);
+
+  // Clauses
+  Ref           alloc(std::vector<Lit> const&, bool);
+  std::uint32_t size(Ref) const;
+  Lit*          lits(Ref);
+  bool          learnt(Ref) const;
+  float         activity(Ref) const;
+  void          set_activity(Ref, float);
+  bool          locked(Ref);
+  void          attach(Ref);
+  void          reduce();
+  void          collect();
+
+  // Search
+  Ref    propagate();
+  void   analyze(Ref, std::vector<Lit>&, int&);
+  bool   redundant(Lit);
+  Lit    decide();
+  Result search(std::uint64_t);
+
+  // Heuristics
+  void bump_var(std::uint32_t);
+  void bump_clause(Ref);
+  void heap_insert(std::uint32_t);
+  void heap_up(std::uint32_t);
+  void heap_down(std::uint32_t);
+  std::uint32_t heap_pop();
+
+  std::vector<std::uint32_t>      mem_;      // Clause storage
+  std::vector<Ref>                clauses_;  // Original clauses
+  std::vector<Ref>                learnts_;  // Learnt clauses
+  std::vector<std::vector<Watch>> watches_;  // Watches of each literal
+
+  std::vector<std::int8_t>   assigns_;  // Value of each variable
+  std::vector<int>           levels_;   // Decision level of each variable
+  std::vector<Ref>           reasons_;  // Implying clause of each variable
+  std::vector<char>          phases_;   // Saved polarity of each variable
+  std::vector<char>          seen_;     // Marks for conflict analysis
+  std::vector<Lit>           trail_;    // Assigned literals, in order
+  std::vector<std::uint32_t> limits_;   // Trail size at each level
+  std::size_t                head_;     // Next literal to propagate
+
+  std::vector<double>        acts_;     // Activity of each variable
+  std::vector<std::uint32_t> heap_;     // Unassigned variables by activity
+  std::vector<int>           places_;   // Position in the heap, or -1
+  double                     var_inc_;  // Activity bump for variables
+  float                      cla_inc_;  // Activity bump for clauses
+  double                     max_learnts_;
+
+  std::vector<char> model_; // Value of each variable, if satisfiable
+  bool              ok_;    // False if the clauses are unsatisfiable
+
+  std::uint64_t decisions_;
+  std::uint64_t propagations_;
+  std::uint64_t conflicts_;
+  std::uint64_t restarts_;
+};
+
+
+// Returns the number of variables.
+inline std::uint32_t
+Sat_solver::variables() const
+{
+  return assigns_.size();
+}
+
+
+// Returns the number of decisions made by the solver.
+inline std::uint64_t
+Sat_solver::decisions() const
+{
+  return decisions_;
+}
+
+
+// Returns the number of literals propagated.
+inline std::uint64_t
+Sat_solver::propagations() const
+{
+  return propagations_;
+}
+
+
+// Returns the number of conflicts found.
+inline std::uint64_t
+Sat_solver::conflicts() const
+{
+  return conflicts_;
+}
+
+
+// Returns the number of restarts.
+inline std::uint64_t
+Sat_solver::restarts() const
+{
+  return restarts_;
+}
+
+
+#endif
@@ -2,22 +2,19 @@
 #include "simplify.hpp"
 #include "equivalent.hpp"
 #include "ast.hpp"
+#include "pool.hpp"
 
+#include <deque>
 
-// An atom cannot be simplified.
-Prop const* 
-simplify(Atom const* p)
-{
-  return p;
-}
 
+namespace
+{
 
+// Simplify the conjunction of p1 and p2, which are
+// already simplified.
 Prop const*
-simplify(And const* p)
+simplify_and(Prop_factory& f, Prop const* p1, Prop const* p2)
 {
-  Prop const* p1 = simplify(p->left());
-  Prop const* p2 = simplify(p->right());
-  
   // idempotence: p and p <=> p
   if (is_equivalent(p1, p2))
     return p1;
@@ -56,17 +53,17 @@ simplify(And const* p)
       return p3;
   }
   
-  return new And(p1, p2);
+  return f.make_and(p1, p2);
 }
 
 
+// Simplify the disjunction of p1 and p2, which are
+// already simplified.
+//
 // FIXME: Handle precedence.
 Prop const*
-simplify(Or const* p)
+simplify_or(Prop_factory& f, Prop const* p1, Prop const* p2)
 {
-  Prop const* p1 = simplify(p->left());
-  Prop const* p2 = simplify(p->right());
-  
   // idempotence: p or p <=> p
   if (is_equivalent(p1, p2))
     return p1;
@@ -108,19 +105,240 @@ simplify(Or const* p)
       return p3;
   }
 
-  return new Or(p1, p2);
+  return f.make_or(p1, p2);
+}
+
+
+// Simplify the negation of p, which is already
+// simplified.
+inline Prop const*
+simplify_not(Prop_factory& f, Prop const* p)
+{
+  // double negation: not not p <=> p
+  if (Not const* p1 = as<Not>(p))
+    return p1->operand();
+
+  return f.make_not(p);
 }
 
 
+// Simplify the implication of p1 and p2, which are
+// already simplified.
+inline Prop const*
+simplify_implies(Prop_factory& f, Prop const* p1, Prop const* p2)
+{
+  return f.make_implies(p1, p2);
+}
+
+} // namespace
+
+
+// Returns a simplified form of p. New propositions
+// are created by the factory f.
+//
+// Operands are simplified before the propositions that
+// use them, without recursion.
 Prop const* 
-simplify(Prop const* p)
+simplify(Prop_factory& f, Prop const* p)
 {
   struct Fn
   {
-    Prop const* operator()(Atom const* p) const { return simplify(p); }
-    Prop const* operator()(And const* p) const { return simplify(p); }
-    Prop const* operator()(Or const* p) const { return simplify(p); }
+    Fn(Prop_factory& f)
+      : f(f)
+    { }
+
+    // An atom cannot be simplified.
+    Prop const* operator()(Atom const* p) const { return p; }
+
+    Prop const* operator()(Not const*, Prop const* p) const
+    {
+      return simplify_not(f, p);
+    }
+
+    Prop const* operator()(And const*, Prop const* p1, Prop const* p2) const 
+    { 
+      return simplify_and(f, p1, p2); 
+    }
+
+    Prop const* operator()(Or const*, Prop const* p1, Prop const* p2) const 
+    { 
+      return simplify_or(f, p1, p2); 
+    }
+
+    Prop const* operator()(Implies const*, Prop const* p1, Prop const* p2) const
+    {
+      return simplify_implies(f, p1, p2);
+    }
+
+    Prop_factory& f;
   };
   
-  return apply(p, Fn());
+  return fold<Prop const*>(p, Fn(f));
+}
+
+
+namespace
+{
+
+// Simplify the binary node b whose operands simplify
+// to p1 and p2.
+inline Prop const*
+simplify_binary(Prop_factory& f, Binary const* b, Prop const* p1, Prop const* p2)
+{
+  switch (b->kind()) {
+    case and_prop:
+      return simplify_and(f, p1, p2);
+    case or_prop:
+      return simplify_or(f, p1, p2);
+    default:
+      return simplify_implies(f, p1, p2);
+  }
+}
+
+
+// Simplify p, forking operands of at least grain nodes
+// onto the pool.
+//
+// The traversal follows the larger operand of each node
+// in a loop, and forks the smaller one if it is large
+// enough. Every forked operand is at most half the size of
+// its parent, so tasks are nested at most O(log n) deep.
+// Small operands are simplified sequentially. A negation
+// has no other operand, and is simplified when the path
+// unwinds.
+Prop const*
+simplify_task(Prop_factory& f, Task_pool& pool, std::uint32_t grain, Prop const* p)
+{
+  struct Frame
+  {
+    Prop const*           node;   // The node on the path
+    bool                  left;   // True if the path goes left
+    Prop const*           other;  // The operand off the path
+    Prop const*           result; // The simplified other operand
+    std::unique_ptr<Task> task;   // Simplifies other, if forked
+  };
+
+  // Frames are not moved as the path grows, so tasks
+  // can write their results into them.
+  std::deque<Frame> path;
+  while (p->size() >= grain && p->kind() != atom_prop) {
+    if (Not const* n = as<Not>(p)) {
+      path.push_back(Frame{n, true, nullptr, nullptr, nullptr});
+      p = n->operand();
+      continue;
+    }
+    Binary const* b = cast<Binary>(p);
+    bool left = b->left()->size() >= b->right()->size();
+    path.push_back(Frame{b, left, left ? b->right() : b->left(), nullptr, nullptr});
+    Frame& fr = path.back();
+    if (fr.other->size() >= grain) {
+      Prop const* q = fr.other;
+      Prop const** out = &fr.result;
+      fr.task.reset(new Task([&f, &pool, grain, q, out]() {
+        *out = simplify_task(f, pool, grain, q);
+      }));
+      pool.fork(*fr.task);
+    }
+    p = left ? b->left() : b->right();
+  }
+
+  try {
+    Prop const* r = simplify(f, p);
+    while (!path.empty()) {
+      Frame& fr = path.back();
+      if (!fr.other) {
+        r = simplify_not(f, r);
+        path.pop_back();
+        continue;
+      }
+      if (fr.task)
+        pool.join(*fr.task);
+      else
+        fr.result = simplify(f, fr.other);
+      Binary const* b = static_cast<Binary const*>(fr.node);
+      if (fr.left)
+        r = simplify_binary(f, b, r, fr.result);
+      else
+        r = simplify_binary(f, b, fr.result, r);
+      path.pop_back();
+    }
+    return r;
+  } catch (...) {
+    // Forked tasks refer to the frames, so they must
+    // finish before the frames are destroyed.
+    for (Frame& fr : path) {
+      if (fr.task) {
+        try {
+          pool.join(*fr.task);
+        } catch (...) { }
+      }
+    }
+    throw;
+  }
+}
+
+} // namespace
+
+
+// Returns a simplified form of p, computed in parallel
+// by the tasks of pool. Operands with fewer than grain
+// nodes are simplified sequentially.
+//
+// The result is the same node as the one returned by the
+// sequential simplify(). The factory must be shared.
+Prop const*
+simplify(Prop_factory& f, Prop const* p, Task_pool& pool, std::uint32_t grain)
+{
+  assert(f.shared());
+  return simplify_task(f, pool, grain ? grain : 1, p);
+}
+
+
+// Returns a simplified form of p, reusing the recorded
+// results of its subpropositions.
+//
+// Nodes are visited from an explicit stack, and a node
+// whose result is recorded is not entered, so only the
+// nodes that are new since the last call are simplified.
+Prop const*
+Simplifier::operator()(Prop const* p)
+{
+  computed_ = 0;
+  std::vector<Prop const*> work {p};
+  while (!work.empty()) {
+    Prop const* q = work.back();
+    if (memo_.count(q)) {
+      work.pop_back();
+      continue;
+    }
+
+    Prop const* r;
+    if (Binary const* b = as<Binary>(q)) {
+      auto i = memo_.find(b->left());
+      if (i == memo_.end()) {
+        work.push_back(b->left());
+        continue;
+      }
+      auto j = memo_.find(b->right());
+      if (j == memo_.end()) {
+        work.push_back(b->right());
+        continue;
+      }
+      r = simplify_binary(f_, b, i->second, j->second);
+    } else if (Not const* n = as<Not>(q)) {
+      auto i = memo_.find(n->operand());
+      if (i == memo_.end()) {
+        work.push_back(n->operand());
+        continue;
+      }
+      r = simplify_not(f_, i->second);
+    } else {
+      // An atom cannot be simplified.
+      r = q;
+    }
+    memo_.emplace(q, r);
+    ++computed_;
+    work.pop_back();
+  }
+  return memo_[p];
 }
@@ -3,10 +3,87 @@
 #define SIMPLIFY_HPP
 
 
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+
 struct Prop;
+class Prop_factory;
+class Task_pool;
+
+
+// The default size of the smallest proposition that
+// is simplified in parallel.
+constexpr std::uint32_t simplify_grain = 1 << 14;
+
+
+Prop const* simplify(Prop_factory&, Prop const*);
+Prop const* simplify(Prop_factory&, Prop const*, Task_pool&, std::uint32_t = simplify_grain);
+
+
+// The simplifier simplifies propositions incrementally.
+//
+// The simplified form of each node is recorded. Because
+// propositions are hash-consed, a node's simplified form
+// depends only on the node itself, so a recorded result
+// stays valid for as long as the node exists. When a
+// subproposition is replaced (see replace()), the new
+// proposition shares every unchanged subtree with the
+// old one, and only the nodes on the path from the edit
+// to the root are simplified again.
+//
+// All propositions must be created by the factory of the
+// simplifier. The recorded results must be cleared when
+// that factory is reset.
+class Simplifier
+{
+public:
+  Simplifier(Prop_factory&);
+
+  Prop const* operator()(Prop const*);
+
+  std::size_t size() const;
+  std::size_t computed() const;
+
+  void clear();
+
+private:
+  Prop_factory&                                f_;        // Creates results
+  std::unordered_map<Prop const*, Prop const*> memo_;     // Recorded results
+  std::size_t                                  computed_; // Nodes simplified
+};
+
+
+inline
+Simplifier::Simplifier(Prop_factory& f)
+  : f_(f), computed_(0)
+{ }
+
+
+// Returns the number of recorded results.
+inline std::size_t
+Simplifier::size() const
+{
+  return memo_.size();
+}
+
+
+// Returns the number of nodes that were simplified by
+// the last call, rather than found in the record.
+inline std::size_t
+Simplifier::computed() const
+{
+  return computed_;
+}
 
 
-Prop const* simplify(Prop const* p);
+// Discard all recorded results.
+inline void
+Simplifier::clear()
+{
+  memo_.clear();
+}
 
 
 #endif
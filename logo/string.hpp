@@ -3,6 +3,7 @@
 #define STRING_HPP
 
 #include <algorithm>
+#include <cstdint>
 #include <iosfwd>
 #include <string>
 #include <stdexcept>
@@ -15,6 +16,11 @@
 using String = std::string;
 
 
+// The byte offset of a character within a source buffer.
+// Offsets are 32 bits, so inputs are limited to 4GB.
+using Offset = std::uint32_t;
+
+
 // Returns true if c is the horizontal whitespace.
 // Note that vertical tabs and carriage returns
 // are considered horizontal white space.
@@ -131,6 +137,9 @@ public:
 
   char const* begin() const;
   char const* end() const;
+  Offset      size() const;
+
+  void replace(Offset, Offset, String const&);
 
 private:
   String buf_;
@@ -163,6 +172,37 @@ Stringbuf::end() const
 }
 
 
+// Returns the number of bytes in the buffer.
+inline Offset
+Stringbuf::size() const
+{
+  return buf_.size();
+}
+
+
+// Replace the n bytes starting at the offset k with
+// the string s. Note that this invalidates all pointers
+// into the buffer.
+inline void
+Stringbuf::replace(Offset k, Offset n, String const& s)
+{
+  buf_.replace(k, n, s);
+}
+
+
+// -------------------------------------------------------------------------- //
+//                              Edits
+
+// An edit replaces the bytes [offset, offset + length)
+// of a buffer with the given text.
+struct Edit
+{
+  Offset offset;
+  Offset length;
+  String text;
+};
+
+
 // -------------------------------------------------------------------------- //
 //                          Character stream
 
@@ -194,6 +234,12 @@ public:
   void ignore(int);
 
   Position position() const;
+  Offset   offset() const;
+  void     seek(Offset);
+
+  Stringbuf const& buffer() const;
+
+  void apply(Edit const&);
 
 private:
   Stringbuf buf_; // The shared buffer.
@@ -274,4 +320,41 @@ Char_stream::position() const
 }
 
 
+// Returns the offset of the current character from
+// the start of the buffer.
+inline Offset
+Char_stream::offset() const
+{
+  return pos_ - buf_.begin();
+}
+
+
+// Move the stream to the character at offset n.
+inline void
+Char_stream::seek(Offset n)
+{
+  pos_ = buf_.begin() + std::min(n, buf_.size());
+}
+
+
+// Returns the underlying string buffer.
+inline Stringbuf const&
+Char_stream::buffer() const
+{
+  return buf_;
+}
+
+
+// Apply the edit to the underlying buffer. The stream
+// keeps its offset, not its position. This moves the
+// text after the edit, so it takes linear time.
+inline void
+Char_stream::apply(Edit const& e)
+{
+  Offset n = offset();
+  buf_.replace(e.offset, e.length, e.text);
+  seek(n);
+}
+
+
 #endif
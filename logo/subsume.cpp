@@ -0,0 +1,236 @@
+
+#include "subsume.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+
+constexpr std::uint32_t Subsumption_index::no_node;
+
+
+namespace
+{
+
+// Returns the signature bit of the literal n.
+inline std::uint64_t
+signature(std::uint32_t n)
+{
+  return std::uint64_t(1) << ((n * 0x9e3779b97f4a7c15) >> 58);
+}
+
+} // namespace
+
+
+// -------------------------------------------------------------------------- //
+//                            Literal sets
+
+// Returns the literal set of p, which must be a literal, or
+// a conjunction or disjunction of literals. The ids of its
+// atoms are assigned by the atom table. Throws
+// std::invalid_argument if p has another form.
+Literal_set
+literal_set(Prop const* p, Atom_table& atoms)
+{
+  // The connective of the set, if p is not a literal.
+  bool binary = is<Binary>(p);
+  Prop_kind k = p->kind();
+  if (k == implies_prop)
+    throw std::invalid_argument("not a clause or a cube");
+
+  Literal_set lits;
+  std::vector<Prop const*> work {p};
+  while (!work.empty()) {
+    Prop const* q = work.back();
+    work.pop_back();
+    if (binary && q->kind() == k) {
+      Binary const* b = cast<Binary>(q);
+      work.push_back(b->right());
+      work.push_back(b->left());
+      continue;
+    }
+
+    std::uint32_t neg = 0;
+    if (Not const* n = as<Not>(q)) {
+      q = n->operand();
+      neg = 1;
+    }
+    Atom const* a = as<Atom>(q);
+    if (!a)
+      throw std::invalid_argument("not a clause or a cube");
+    lits.push_back(2 * atoms.get(a->symbol()) + neg);
+  }
+  std::sort(lits.begin(), lits.end());
+  lits.erase(std::unique(lits.begin(), lits.end()), lits.end());
+  return lits;
+}
+
+
+// -------------------------------------------------------------------------- //
+//                          Subsumption index
+
+Subsumption_index::Subsumption_index()
+  : nodes_(1, Node{no_node, {}, {}}), size_(0)
+{ }
+
+
+// Returns the child of node n labeled lit, or no_node.
+std::uint32_t
+Subsumption_index::child(std::uint32_t n, std::uint32_t lit) const
+{
+  std::vector<std::uint32_t> const& cs = nodes_[n].children;
+  auto iter = std::lower_bound(cs.begin(), cs.end(), lit, [this](std::uint32_t c, std::uint32_t l) {
+    return nodes_[c].lit < l;
+  });
+  if (iter != cs.end() && nodes_[*iter].lit == lit)
+    return *iter;
+  return no_node;
+}
+
+
+// Store the literal set s, and return its id. Equal sets
+// are stored with different ids.
+Subsumption_index::Id
+Subsumption_index::insert(Literal_set const& s)
+{
+  std::uint64_t sig = 0;
+  for (std::uint32_t l : s)
+    sig |= signature(l);
+
+  Id id = sets_.size();
+  std::uint32_t n = 0;
+  for (std::uint32_t l : s) {
+    if (l >= occurs_.size())
+      occurs_.resize(l + 1);
+    occurs_[l].push_back(id);
+
+    std::uint32_t c = child(n, l);
+    if (c == no_node) {
+      c = nodes_.size();
+      nodes_.push_back(Node{l, {}, {}});
+      std::vector<std::uint32_t>& cs = nodes_[n].children;
+      auto iter = std::lower_bound(cs.begin(), cs.end(), l, [this](std::uint32_t x, std::uint32_t y) {
+        return nodes_[x].lit < y;
+      });
+      cs.insert(iter, c);
+    }
+    n = c;
+  }
+
+  nodes_[n].ends.push_back(id);
+  sets_.push_back(s);
+  sigs_.push_back(sig);
+  where_.push_back(n);
+  ++size_;
+  return id;
+}
+
+
+// Remove the set with the given id from the index. Its
+// occurrences are skipped by later queries.
+void
+Subsumption_index::erase(Id id)
+{
+  std::uint32_t n = where_[id];
+  if (n == no_node)
+    return;
+  std::vector<Id>& ends = nodes_[n].ends;
+  ends.erase(std::find(ends.begin(), ends.end(), id));
+  where_[id] = no_node;
+  --size_;
+}
+
+
+// Returns the ids of the stored sets that are subsets of
+// the query q.
+//
+// Every label on the path of a match is in q. So from a
+// node reached after matching q up to position i, only
+// the children labeled by a later literal of q are
+// visited: either by looking up each later literal, or,
+// if there are fewer children, by scanning them. A child
+// whose label is not in the signature of q is skipped
+// without searching q.
+std::vector<Subsumption_index::Id>
+Subsumption_index::subsets(Literal_set const& q) const
+{
+  struct Frame
+  {
+    std::uint32_t node;
+    std::size_t   pos; // Literals of q not yet matched
+  };
+
+  std::uint64_t sig = 0;
+  for (std::uint32_t l : q)
+    sig |= signature(l);
+
+  std::vector<Id> ids;
+  std::vector<Frame> work {{0, 0}};
+  while (!work.empty()) {
+    Frame f = work.back();
+    work.pop_back();
+    Node const& n = nodes_[f.node];
+    ids.insert(ids.end(), n.ends.begin(), n.ends.end());
+
+    // Look up the rest of q when it is shorter than the
+    // list of children.
+    if (q.size() - f.pos < n.children.size()) {
+      for (std::size_t i = f.pos; i < q.size(); ++i) {
+        std::uint32_t c = child(f.node, q[i]);
+        if (c != no_node)
+          work.push_back({c, i + 1});
+      }
+      continue;
+    }
+    for (std::uint32_t c : n.children) {
+      std::uint32_t l = nodes_[c].lit;
+      if (f.pos == q.size() || l > q.back())
+        break;
+      if (!(sig & signature(l)))
+        continue;
+      auto iter = std::lower_bound(q.begin() + f.pos, q.end(), l);
+      if (iter != q.end() && *iter == l)
+        work.push_back({c, std::size_t(iter - q.begin()) + 1});
+    }
+  }
+  return ids;
+}
+
+
+// Returns the ids of the stored sets that are supersets of
+// the query q.
+//
+// In the trie, a superset may branch off before any
+// literal of q, so a search would visit most of the upper
+// levels. Instead, the candidates are the sets that have
+// the literal of q with the fewest occurrences. A
+// candidate whose signature lacks a literal of q is
+// rejected without comparing the sets.
+std::vector<Subsumption_index::Id>
+Subsumption_index::supersets(Literal_set const& q) const
+{
+  std::vector<Id> ids;
+  if (q.empty()) {
+    for (Id id = 0; id < sets_.size(); ++id)
+      if (where_[id] != no_node)
+        ids.push_back(id);
+    return ids;
+  }
+
+  std::uint64_t sig = 0;
+  std::vector<Id> const* cands = nullptr;
+  for (std::uint32_t l : q) {
+    sig |= signature(l);
+    if (l >= occurs_.size())
+      return ids;
+    if (!cands || occurs_[l].size() < cands->size())
+      cands = &occurs_[l];
+  }
+  for (Id id : *cands) {
+    if (where_[id] == no_node || (sig & ~sigs_[id]))
+      continue;
+    Literal_set const& s = sets_[id];
+    if (std::includes(s.begin(), s.end(), q.begin(), q.end()))
+      ids.push_back(id);
+  }
+  return ids;
+}
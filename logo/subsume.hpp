@@ -0,0 +1,95 @@
+#ifndef SUBSUME_HPP
+#define SUBSUME_HPP
+
+#include "flat.hpp"
+
+#include <cstdint>
+#include <vector>
+
+
+// -------------------------------------------------------------------------- //
+//                            Literal sets
+
+// A literal set is a sorted list of literal ids without
+// repetition. The literal id of an atom with id a is 2a,
+// and of its negation, 2a + 1.
+using Literal_set = std::vector<std::uint32_t>;
+
+Literal_set literal_set(Prop const*, Atom_table&);
+
+
+// -------------------------------------------------------------------------- //
+//                          Subsumption index
+
+// A subsumption index stores literal sets, and finds the
+// stored sets that are subsets or supersets of a query.
+//
+// For clauses (disjunctions of literals), a clause
+// subsumes every clause that contains its literals, so
+// subsets() finds the stored clauses that subsume a query
+// (forward subsumption), and supersets() finds those that
+// it subsumes (backward subsumption). For cubes
+// (conjunctions of literals), the roles are reversed.
+//
+// The sets are stored in a set-trie: each set is a path
+// from the root, labeled by its literals in increasing
+// order, so sets with a common prefix share nodes. A
+// subset query visits only the paths labeled by literals
+// of the query. Supersets are found from the occurrence
+// lists of the literals. Each set has a signature, a
+// 64-bit hash of its literals, which rejects most sets
+// that lack a literal of the query without comparing them.
+class Subsumption_index
+{
+public:
+  using Id = std::uint32_t;
+
+  Subsumption_index();
+
+  Id   insert(Literal_set const&);
+  void erase(Id);
+
+  std::size_t        size() const;
+  Literal_set const& set(Id) const;
+
+  std::vector<Id> subsets(Literal_set const&) const;
+  std::vector<Id> supersets(Literal_set const&) const;
+
+private:
+  static constexpr std::uint32_t no_node = -1;
+
+  struct Node
+  {
+    std::uint32_t              lit;      // Label of the edge to the node
+    std::vector<std::uint32_t> children; // Children, by label
+    std::vector<Id>            ends;     // Sets whose path ends here
+  };
+
+  std::uint32_t child(std::uint32_t, std::uint32_t) const;
+
+  std::vector<Node>            nodes_;  // The root is first
+  std::vector<Literal_set>     sets_;   // Literals of each set
+  std::vector<std::uint64_t>   sigs_;   // Signature of each set
+  std::vector<std::uint32_t>   where_;  // Last node of each set, or no_node
+  std::vector<std::vector<Id>> occurs_; // Sets of each literal
+  std::size_t                  size_;   // Number of sets not erased
+};
+
+
+// Returns the number of stored sets.
+inline std::size_t
+Subsumption_index::size() const
+{
+  return size_;
+}
+
+
+// Returns the literals of the set with the given id.
+inline Literal_set const&
+Subsumption_index::set(Id id) const
+{
+  return sets_[id];
+}
+
+
+#endif
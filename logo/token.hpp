@@ -20,6 +20,7 @@ enum Token_kind
   rparen_tok,
   and_tok,
   or_tok,
+  not_tok,
   arrow_tok,
   identifier_tok,
 };
@@ -35,22 +36,27 @@ enum Token_kind
 // to define their own token enumeration wihtout
 // having to instantiate a new token class.
 //
-// TODO: Keep the source code location.
+// The source location of a token is kept as the byte
+// offset of its first character. Line and column
+// numbers are computed on demand by a Line_map.
 class Token
 {
 public:
   Token();
   Token(int);
   Token(int, Symbol const*);
+  Token(int, Symbol const*, Offset);
 
   explicit operator bool() const;
 
   int           kind() const;
+  Offset        offset() const;
   Symbol const* symbol() const;
   String const& spelling() const;
 
 private:
   int           kind_;
+  Offset        loc_;
   Symbol const* sym_;
 };
 
@@ -73,7 +79,15 @@ Token::Token(int k)
 // symbol table entry.
 inline
 Token::Token(int k, Symbol const* s)
-  : kind_(k), sym_(s)
+  : Token(k, s, 0)
+{ }
+
+
+// Initialize a token of kind k with the given symbol
+// table entry, starting at the byte offset n.
+inline
+Token::Token(int k, Symbol const* s, Offset n)
+  : kind_(k), loc_(n), sym_(s)
 { }
 
 
@@ -94,6 +108,15 @@ Token::kind() const
 }
 
 
+// Returns the byte offset of the token in the
+// source buffer.
+inline Offset
+Token::offset() const
+{
+  return loc_;
+}
+
+
 // Returns the token's symbol and attributes.
 inline Symbol const* 
 Token::symbol() const
@@ -128,6 +151,20 @@ struct Tokenbuf : std::list<Token>
 };
 
 
+// Describes a change to a token buffer made by
+// re-lexing an edited input. The new tokens are
+// [first, last), where last is the first unchanged
+// token following the edit. The tokens that were
+// replaced are moved into removed, so iterators to
+// them remain valid until the edit is destroyed.
+struct Token_edit
+{
+  Tokenbuf::iterator first;
+  Tokenbuf::iterator last;
+  Tokenbuf           removed;
+};
+
+
 // -------------------------------------------------------------------------- //
 //                            Token stream
 
@@ -152,6 +189,11 @@ public:
   void put(Token);
 
   Position position() const; 
+  void     seek(Position);
+  void     rewind();
+
+  Tokenbuf&       buffer();
+  Tokenbuf const& buffer() const;
 
 private:
   Tokenbuf buf_;
@@ -219,4 +261,35 @@ Token_stream::position() const
 }
 
 
+// Move the stream to the given position.
+inline void
+Token_stream::seek(Position p)
+{
+  pos_ = p;
+}
+
+
+// Move the stream back to the first token.
+inline void
+Token_stream::rewind()
+{
+  pos_ = buf_.begin();
+}
+
+
+// Returns the underlying token buffer.
+inline Tokenbuf&
+Token_stream::buffer()
+{
+  return buf_;
+}
+
+
+inline Tokenbuf const&
+Token_stream::buffer() const
+{
+  return buf_;
+}
+
+
 #endif
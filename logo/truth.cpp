@@ -0,0 +1,397 @@
+
+#include "truth.hpp"
+#include "ast.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#  include <immintrin.h>
+#elif defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+
+namespace
+{
+
+// -------------------------------------------------------------------------- //
+//                              Word operations
+
+// Each operation combines words of bits, and vectors of
+// words where SIMD is available. Negation ignores its
+// second operand.
+
+struct Not_op
+{
+  static std::uint64_t word(std::uint64_t a, std::uint64_t) { return ~a; }
+#if defined(__AVX512F__)
+  static __m512i simd(__m512i a, __m512i) { return _mm512_xor_si512(a, _mm512_set1_epi64(-1)); }
+#elif defined(__AVX2__)
+  static __m256i simd(__m256i a, __m256i) { return _mm256_xor_si256(a, _mm256_set1_epi64x(-1)); }
+#elif defined(__SSE2__)
+  static __m128i simd(__m128i a, __m128i) { return _mm_xor_si128(a, _mm_set1_epi32(-1)); }
+#endif
+};
+
+
+struct And_op
+{
+  static std::uint64_t word(std::uint64_t a, std::uint64_t b) { return a & b; }
+#if defined(__AVX512F__)
+  static __m512i simd(__m512i a, __m512i b) { return _mm512_and_si512(a, b); }
+#elif defined(__AVX2__)
+  static __m256i simd(__m256i a, __m256i b) { return _mm256_and_si256(a, b); }
+#elif defined(__SSE2__)
+  static __m128i simd(__m128i a, __m128i b) { return _mm_and_si128(a, b); }
+#endif
+};
+
+
+struct Or_op
+{
+  static std::uint64_t word(std::uint64_t a, std::uint64_t b) { return a | b; }
+#if defined(__AVX512F__)
+  static __m512i simd(__m512i a, __m512i b) { return _mm512_or_si512(a, b); }
+#elif defined(__AVX2__)
+  static __m256i simd(__m256i a, __m256i b) { return _mm256_or_si256(a, b); }
+#elif defined(__SSE2__)
+  static __m128i simd(__m128i a, __m128i b) { return _mm_or_si128(a, b); }
+#endif
+};
+
+
+struct Implies_op
+{
+  static std::uint64_t word(std::uint64_t a, std::uint64_t b) { return ~a | b; }
+#if defined(__AVX512F__)
+  static __m512i simd(__m512i a, __m512i b) { return _mm512_or_si512(Not_op::simd(a, b), b); }
+#elif defined(__AVX2__)
+  static __m256i simd(__m256i a, __m256i b) { return _mm256_or_si256(Not_op::simd(a, b), b); }
+#elif defined(__SSE2__)
+  static __m128i simd(__m128i a, __m128i b) { return _mm_or_si128(Not_op::simd(a, b), b); }
+#endif
+};
+
+
+// Store the operation applied to the n words of a and b
+// in d. With AVX-512, AVX2 or SSE2, the words are combined
+// 8, 4 or 2 at a time.
+template<typename Op>
+void
+combine(std::uint64_t* d, std::uint64_t const* a, std::uint64_t const* b, std::size_t n)
+{
+  std::size_t i = 0;
+#if defined(__AVX512F__)
+  for (; i + 8 <= n; i += 8) {
+    __m512i x = _mm512_loadu_si512(a + i);
+    __m512i y = _mm512_loadu_si512(b + i);
+    _mm512_storeu_si512(d + i, Op::simd(x, y));
+  }
+#elif defined(__AVX2__)
+  for (; i + 4 <= n; i += 4) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+    __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), Op::simd(x, y));
+  }
+#elif defined(__SSE2__)
+  for (; i + 2 <= n; i += 2) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a + i));
+    __m128i y = _mm_loadu_si128(reinterpret_cast<__m128i const*>(b + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), Op::simd(x, y));
+  }
+#endif
+  for (; i < n; ++i)
+    d[i] = Op::word(a[i], b[i]);
+}
+
+
+// -------------------------------------------------------------------------- //
+//                              Evaluation
+
+// Returns the words of p, where each word holds the values
+// of 64 assignments. The words of each atom are written by
+// fill(s, bits), where s is its symbol.
+//
+// The distinct nodes of p are numbered in post-order from
+// an explicit stack, then evaluated in one pass. The words
+// of a node are released to a pool after its last use, so
+// only the nodes that remain to be used hold memory.
+template<typename Fill>
+std::vector<std::uint64_t>
+evaluate(Prop const* p, std::size_t words, Fill fill)
+{
+  std::unordered_map<Prop const*, std::uint32_t> index;
+  std::vector<Prop const*> nodes;
+  std::vector<std::uint32_t> left, right, uses;
+  std::vector<Prop const*> work {p};
+  while (!work.empty()) {
+    Prop const* q = work.back();
+    if (index.count(q)) {
+      work.pop_back();
+      continue;
+    }
+
+    // Number the operands of a node before the node.
+    std::size_t n = work.size();
+    if (Not const* r = as<Not>(q)) {
+      if (!index.count(r->operand()))
+        work.push_back(r->operand());
+    } else if (Binary const* r = as<Binary>(q)) {
+      if (!index.count(r->right()))
+        work.push_back(r->right());
+      if (!index.count(r->left()))
+        work.push_back(r->left());
+    }
+    if (work.size() != n)
+      continue;
+    work.pop_back();
+
+    std::uint32_t l = 0, r = 0;
+    if (Not const* n = as<Not>(q)) {
+      l = r = index[n->operand()];
+      ++uses[l];
+    } else if (Binary const* b = as<Binary>(q)) {
+      l = index[b->left()];
+      r = index[b->right()];
+      ++uses[l];
+      ++uses[r];
+    }
+    index.emplace(q, nodes.size());
+    nodes.push_back(q);
+    left.push_back(l);
+    right.push_back(r);
+    uses.push_back(0);
+  }
+
+  std::vector<std::vector<std::uint64_t>> bits(nodes.size());
+  std::vector<std::vector<std::uint64_t>> pool;
+  auto release = [&](std::uint32_t i) {
+    if (--uses[i] == 0)
+      pool.push_back(std::move(bits[i]));
+  };
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    std::vector<std::uint64_t>& d = bits[i];
+    if (pool.empty()) {
+      d.resize(words);
+    } else {
+      d = std::move(pool.back());
+      pool.pop_back();
+    }
+
+    Prop const* q = nodes[i];
+    std::uint64_t const* a = bits[left[i]].data();
+    std::uint64_t const* b = bits[right[i]].data();
+    switch (q->kind()) {
+      case atom_prop:
+        fill(cast<Atom>(q)->symbol(), d.data());
+        continue;
+      case not_prop:
+        combine<Not_op>(d.data(), a, b, words);
+        break;
+      case and_prop:
+        combine<And_op>(d.data(), a, b, words);
+        break;
+      case or_prop:
+        combine<Or_op>(d.data(), a, b, words);
+        break;
+      case implies_prop:
+        combine<Implies_op>(d.data(), a, b, words);
+        break;
+    }
+    release(left[i]);
+    if (!is<Not>(q))
+      release(right[i]);
+  }
+  return std::move(bits.back());
+}
+
+
+// Returns a map from each symbol to its position in syms.
+std::unordered_map<Symbol const*, std::size_t>
+positions(std::vector<Symbol const*> const& syms)
+{
+  std::unordered_map<Symbol const*, std::size_t> map;
+  for (std::size_t i = 0; i < syms.size(); ++i)
+    map.emplace(syms[i], i);
+  return map;
+}
+
+
+// The number of random assignments tried by
+// may_be_equivalent(), in words.
+constexpr std::size_t sample_words = 8;
+
+
+// Returns the next number of a splitmix64 sequence.
+inline std::uint64_t
+splitmix(std::uint64_t& x)
+{
+  std::uint64_t z = (x += 0x9e3779b97f4a7c15);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+} // namespace
+
+
+// -------------------------------------------------------------------------- //
+//                              Truth tables
+
+// Construct the false table of n atoms.
+Truth_table::Truth_table(std::size_t n)
+  : atoms_(n)
+{
+  if (n > truth_table_atoms)
+    throw std::length_error("too many atoms for a truth table");
+  bits_.assign(n < 6 ? 1 : std::size_t(1) << (n - 6), 0);
+}
+
+
+// Returns the number of rows that are true.
+std::uint64_t
+Truth_table::count() const
+{
+  std::uint64_t n = 0;
+  for (std::uint64_t w : bits_)
+    n += __builtin_popcountll(w);
+
+  // A small table repeats in its word.
+  if (atoms_ < 6)
+    n >>= 6 - atoms_;
+  return n;
+}
+
+
+// Returns true if every row is true.
+bool
+Truth_table::is_true() const
+{
+  for (std::uint64_t w : bits_)
+    if (~w)
+      return false;
+  return true;
+}
+
+
+// Returns true if every row is false.
+bool
+Truth_table::is_false() const
+{
+  for (std::uint64_t w : bits_)
+    if (w)
+      return false;
+  return true;
+}
+
+
+// -------------------------------------------------------------------------- //
+//                          Bit-parallel evaluation
+
+// Returns the distinct atoms of p, from left to right.
+std::vector<Symbol const*>
+support(Prop const* p)
+{
+  std::vector<Symbol const*> syms;
+  std::unordered_set<Prop const*> seen;
+  std::vector<Prop const*> work {p};
+  while (!work.empty()) {
+    Prop const* q = work.back();
+    work.pop_back();
+    if (!seen.insert(q).second)
+      continue;
+    if (Atom const* a = as<Atom>(q)) {
+      syms.push_back(a->symbol());
+    } else if (Not const* n = as<Not>(q)) {
+      work.push_back(n->operand());
+    } else {
+      Binary const* b = cast<Binary>(q);
+      work.push_back(b->right());
+      work.push_back(b->left());
+    }
+  }
+  return syms;
+}
+
+
+// Returns the truth table of p over its support.
+Truth_table
+truth_table(Prop const* p)
+{
+  return truth_table(p, support(p));
+}
+
+
+// Returns the truth table of p over the atoms syms, which
+// must include every atom of p. Throws std::length_error
+// if there are more than truth_table_atoms atoms.
+//
+// Each atom is given the column of the table that is true
+// in the rows that assign it true. For the first six
+// atoms, that is a repeating pattern within each word; for
+// the others, it selects whole words. Then the table of p
+// is computed in one pass over its nodes.
+Truth_table
+truth_table(Prop const* p, std::vector<Symbol const*> const& syms)
+{
+  static constexpr std::uint64_t columns[6] = {
+    0xaaaaaaaaaaaaaaaa,
+    0xcccccccccccccccc,
+    0xf0f0f0f0f0f0f0f0,
+    0xff00ff00ff00ff00,
+    0xffff0000ffff0000,
+    0xffffffff00000000,
+  };
+
+  Truth_table t(syms.size());
+  std::unordered_map<Symbol const*, std::size_t> map = positions(syms);
+  std::size_t words = t.words();
+  auto fill = [&](Symbol const* s, std::uint64_t* bits) {
+    auto iter = map.find(s);
+    if (iter == map.end())
+      throw std::invalid_argument("atom not in the truth table");
+    std::size_t i = iter->second;
+    for (std::size_t w = 0; w < words; ++w) {
+      if (i < 6)
+        bits[w] = columns[i];
+      else
+        bits[w] = (w >> (i - 6)) & 1 ? ~std::uint64_t(0) : 0;
+    }
+  };
+  std::vector<std::uint64_t> bits = evaluate(p, words, fill);
+  std::copy(bits.begin(), bits.end(), t.data());
+  return t;
+}
+
+
+// Returns false if a and b differ under one of a sample of
+// random assignments, in which case they are not
+// equivalent. Otherwise they may be equivalent.
+//
+// Both are evaluated over the same assignments, which are
+// the same on every call. This is a cheap filter before
+// a complete test.
+bool
+may_be_equivalent(Prop const* a, Prop const* b)
+{
+  std::vector<Symbol const*> syms = support(a);
+  std::unordered_map<Symbol const*, std::size_t> map = positions(syms);
+  for (Symbol const* s : support(b)) {
+    if (map.emplace(s, syms.size()).second)
+      syms.push_back(s);
+  }
+
+  std::vector<std::uint64_t> columns(syms.size() * sample_words);
+  std::uint64_t seed = 0;
+  for (std::uint64_t& w : columns)
+    w = splitmix(seed);
+
+  auto fill = [&](Symbol const* s, std::uint64_t* bits) {
+    std::uint64_t const* col = &columns[map.find(s)->second * sample_words];
+    std::copy(col, col + sample_words, bits);
+  };
+  return evaluate(a, sample_words, fill) == evaluate(b, sample_words, fill);
+}
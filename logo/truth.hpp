@@ -0,0 +1,124 @@
+#ifndef TRUTH_HPP
+#define TRUTH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+struct Prop;
+class Symbol;
+
+
+// The most atoms of a truth table. A table of 24 atoms
+// takes 2 MB.
+constexpr std::size_t truth_table_atoms = 24;
+
+
+// -------------------------------------------------------------------------- //
+//                              Truth tables
+
+// A truth table gives the value of a proposition under
+// every assignment to a list of atoms. Row r assigns true
+// to atom i if bit i of r is set, and the value of row r
+// is bit r of the table.
+//
+// A table of n atoms has 2^n rows, packed into 64-bit
+// words. When n is less than 6, the table is one word, in
+// which the rows repeat.
+class Truth_table
+{
+public:
+  Truth_table();
+  explicit Truth_table(std::size_t);
+
+  std::size_t atoms() const;
+  std::size_t words() const;
+
+  std::uint64_t const* data() const;
+  std::uint64_t*       data();
+
+  bool          value(std::uint64_t) const;
+  std::uint64_t count() const;
+  bool          is_true() const;
+  bool          is_false() const;
+
+  friend bool operator==(Truth_table const&, Truth_table const&);
+  friend bool operator!=(Truth_table const&, Truth_table const&);
+
+private:
+  std::size_t                atoms_;
+  std::vector<std::uint64_t> bits_;
+};
+
+
+inline
+Truth_table::Truth_table()
+  : atoms_(0), bits_(1)
+{ }
+
+
+// Returns the number of atoms.
+inline std::size_t
+Truth_table::atoms() const
+{
+  return atoms_;
+}
+
+
+// Returns the number of words.
+inline std::size_t
+Truth_table::words() const
+{
+  return bits_.size();
+}
+
+
+inline std::uint64_t const*
+Truth_table::data() const
+{
+  return bits_.data();
+}
+
+
+inline std::uint64_t*
+Truth_table::data()
+{
+  return bits_.data();
+}
+
+
+// Returns the value of the given row.
+inline bool
+Truth_table::value(std::uint64_t row) const
+{
+  return bits_[row / 64] >> (row % 64) & 1;
+}
+
+
+inline bool
+operator==(Truth_table const& a, Truth_table const& b)
+{
+  return a.atoms_ == b.atoms_ && a.bits_ == b.bits_;
+}
+
+
+inline bool
+operator!=(Truth_table const& a, Truth_table const& b)
+{
+  return !(a == b);
+}
+
+
+// -------------------------------------------------------------------------- //
+//                          Bit-parallel evaluation
+
+std::vector<Symbol const*> support(Prop const*);
+
+Truth_table truth_table(Prop const*);
+Truth_table truth_table(Prop const*, std::vector<Symbol const*> const&);
+
+bool may_be_equivalent(Prop const*, Prop const*);
+
+
+#endif
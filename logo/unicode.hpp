@@ -0,0 +1,128 @@
+#ifndef UNICODE_HPP
+#define UNICODE_HPP
+
+#include <cstdint>
+
+
+// -------------------------------------------------------------------------- //
+//                          Character classes
+
+// Character class flags for ASCII characters.
+enum Char_class : std::uint8_t
+{
+  ident_start_class    = 0x01,
+  ident_continue_class = 0x02,
+};
+
+
+// The character classes of each ASCII character.
+extern std::uint8_t const ascii_class[128];
+
+
+// Returns true if the code point c may start an
+// identifier. ASCII characters are classified by
+// ascii_class, and others by XID_Start.
+bool is_ident_start(char32_t c);
+
+
+// Returns true if the code point c may continue an
+// identifier. ASCII characters are classified by
+// ascii_class, and others by XID_Continue.
+bool is_ident_continue(char32_t c);
+
+
+// -------------------------------------------------------------------------- //
+//                                UTF-8
+
+// Returns true if c is an ASCII character.
+inline bool
+is_ascii(char c)
+{
+  return static_cast<unsigned char>(c) < 0x80;
+}
+
+
+// Returns true if c is a continuation byte of a
+// multibyte UTF-8 sequence.
+inline bool
+is_continuation(char c)
+{
+  return (static_cast<unsigned char>(c) & 0xc0) == 0x80;
+}
+
+
+// Decode the UTF-8 sequence starting at p and ending
+// before last, storing the code point in c. Returns the
+// length of the sequence, or 0 if it is not well-formed.
+// Overlong encodings and surrogates are not well-formed.
+inline int
+decode_utf8(char const* p, char const* last, char32_t& c)
+{
+  auto byte = [p](int i) { return static_cast<unsigned char>(p[i]); };
+
+  unsigned char b0 = byte(0);
+  if (b0 < 0x80) {
+    c = b0;
+    return 1;
+  }
+
+  // Determine the length and the bounds of the second
+  // byte of the sequence.
+  int n;
+  unsigned char lo = 0x80, hi = 0xbf;
+  if (b0 < 0xc2)
+    return 0;
+  else if (b0 < 0xe0)
+    n = 2, c = b0 & 0x1f;
+  else if (b0 < 0xf0)
+    n = 3, c = b0 & 0x0f, lo = b0 == 0xe0 ? 0xa0 : 0x80, hi = b0 == 0xed ? 0x9f : 0xbf;
+  else if (b0 < 0xf5)
+    n = 4, c = b0 & 0x07, lo = b0 == 0xf0 ? 0x90 : 0x80, hi = b0 == 0xf4 ? 0x8f : 0xbf;
+  else
+    return 0;
+
+  if (last - p < n)
+    return 0;
+  if (byte(1) < lo || hi < byte(1))
+    return 0;
+  for (int i = 1; i < n; ++i) {
+    if (!is_continuation(p[i]))
+      return 0;
+    c = (c << 6) | (byte(i) & 0x3f);
+  }
+  return n;
+}
+
+
+// Decode the UTF-8 sequence starting at p, which is
+// known to be well-formed, storing the code point in c.
+// Returns the length of the sequence.
+inline int
+decode_utf8(char const* p, char32_t& c)
+{
+  auto byte = [p](int i) { return static_cast<unsigned char>(p[i]); };
+
+  unsigned char b0 = byte(0);
+  if (b0 < 0x80) {
+    c = b0;
+    return 1;
+  } else if (b0 < 0xe0) {
+    c = (b0 & 0x1f) << 6 | (byte(1) & 0x3f);
+    return 2;
+  } else if (b0 < 0xf0) {
+    c = (b0 & 0x0f) << 12 | (byte(1) & 0x3f) << 6 | (byte(2) & 0x3f);
+    return 3;
+  } else {
+    c = (b0 & 0x07) << 18 | (byte(1) & 0x3f) << 12 | (byte(2) & 0x3f) << 6 | (byte(3) & 0x3f);
+    return 4;
+  }
+}
+
+
+// Returns a pointer to the first byte in [first, last)
+// that does not start a well-formed UTF-8 sequence, or
+// last if the entire range is valid.
+char const* find_invalid_utf8(char const* first, char const* last);
+
+
+#endif
@@ -0,0 +1,173 @@
+
+#include "vm.hpp"
+
+#include <stdexcept>
+
+
+// -------------------------------------------------------------------------- //
+//                              Compilation
+
+// Returns the program that evaluates p. The ids of its
+// atoms are assigned by the atom table.
+//
+// The code of a proposition is generated with two labels:
+// where to go if it is true, and where to go if it is
+// false. An atom tests its value and jumps to one of them.
+// A negation swaps the labels. A conjunction jumps to its
+// false label if its left operand is false, and otherwise
+// continues with its right operand; disjunction and
+// implication are similar. The labels of the whole
+// proposition are the two return instructions.
+//
+// The code that follows a proposition is always at one
+// of its labels, so each test needs only one target. The
+// tests are generated with both labels, and are resolved
+// to a jump to the other label once all labels are placed.
+//
+// Propositions are visited from an explicit stack, so p
+// may be arbitrarily deep. Shared subpropositions are
+// compiled at each use, so the size of the program is the
+// size of p as a tree.
+Program
+compile(Prop const* p, Atom_table& atoms)
+{
+  // A task generates the code of a proposition, or, if
+  // it has none, places the label t.
+  struct Task
+  {
+    Prop const*   p;
+    std::uint32_t t;
+    std::uint32_t f;
+  };
+
+  if (p->size() > program_limit)
+    throw std::length_error("proposition too large to compile");
+
+  Program prog;
+  std::vector<Instruction>& code = prog.code_;
+  std::vector<std::uint32_t> falses;       // False label of each test
+  std::vector<std::uint32_t> labels(2);    // Position of each label
+  code.reserve(p->size() + 2);
+  falses.reserve(p->size());
+
+  std::vector<Task> work {{p, 0, 1}};
+  while (!work.empty()) {
+    Task k = work.back();
+    work.pop_back();
+    if (!k.p) {
+      labels[k.t] = code.size();
+      continue;
+    }
+
+    // The left operand is generated first, followed by
+    // the label m of the right operand.
+    std::uint32_t m = labels.size();
+    switch (k.p->kind()) {
+      case atom_prop:
+        code.push_back({jump_true_op, atoms.get(cast<Atom>(k.p)->symbol()), k.t});
+        falses.push_back(k.f);
+        continue;
+      case not_prop:
+        work.push_back({cast<Not>(k.p)->operand(), k.f, k.t});
+        continue;
+      case and_prop:
+        work.push_back({cast<Binary>(k.p)->right(), k.t, k.f});
+        work.push_back({nullptr, m, 0});
+        work.push_back({cast<Binary>(k.p)->left(), m, k.f});
+        break;
+      case or_prop:
+        work.push_back({cast<Binary>(k.p)->right(), k.t, k.f});
+        work.push_back({nullptr, m, 0});
+        work.push_back({cast<Binary>(k.p)->left(), k.t, m});
+        break;
+      case implies_prop:
+        work.push_back({cast<Binary>(k.p)->right(), k.t, k.f});
+        work.push_back({nullptr, m, 0});
+        work.push_back({cast<Binary>(k.p)->left(), m, k.t});
+        break;
+    }
+    labels.push_back(0);
+  }
+
+  labels[0] = code.size();
+  code.push_back({ret_true_op, 0, 0});
+  labels[1] = code.size();
+  code.push_back({ret_false_op, 0, 0});
+
+  // A test that falls through to its true label jumps to
+  // its false label when the atom is false.
+  for (std::uint32_t i = 0; i < falses.size(); ++i) {
+    Instruction& x = code[i];
+    std::uint32_t t = labels[x.target];
+    if (t == i + 1) {
+      x.op = jump_false_op;
+      x.target = labels[falses[i]];
+    } else {
+      x.target = t;
+    }
+  }
+  return prog;
+}
+
+
+// -------------------------------------------------------------------------- //
+//                               Execution
+
+// Returns the value of the program for a record.
+//
+// With GCC and Clang, each instruction jumps directly to
+// the code of the next, through a table of label
+// addresses. Otherwise, the instructions are selected by
+// a switch in a loop.
+bool
+Program::run(std::uint8_t const* r) const
+{
+  Instruction const* code = code_.data();
+  Instruction const* ip = code;
+#if defined(__GNUC__)
+  static void* const ops[] = {
+    &&do_jump_true,
+    &&do_jump_false,
+    &&do_ret_true,
+    &&do_ret_false,
+  };
+
+  goto *ops[ip->op];
+do_jump_true:
+  ip = r[ip->atom] ? code + ip->target : ip + 1;
+  goto *ops[ip->op];
+do_jump_false:
+  ip = r[ip->atom] ? ip + 1 : code + ip->target;
+  goto *ops[ip->op];
+do_ret_true:
+  return true;
+do_ret_false:
+  return false;
+#else
+  while (true) {
+    switch (ip->op) {
+      case jump_true_op:
+        ip = r[ip->atom] ? code + ip->target : ip + 1;
+        break;
+      case jump_false_op:
+        ip = r[ip->atom] ? ip + 1 : code + ip->target;
+        break;
+      case ret_true_op:
+        return true;
+      case ret_false_op:
+        return false;
+    }
+  }
+#endif
+}
+
+
+// Evaluate the program for n records, the first at
+// records and each stride bytes after the previous, and
+// store the value of each in out.
+void
+Program::run(std::uint8_t const* records, std::size_t stride, std::size_t n, std::uint8_t* out) const
+{
+  for (std::size_t i = 0; i < n; ++i, records += stride)
+    out[i] = run(records);
+}
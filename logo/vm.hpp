@@ -0,0 +1,96 @@
+#ifndef VM_HPP
+#define VM_HPP
+
+#include "flat.hpp"
+
+#include <cstdint>
+#include <vector>
+
+
+// -------------------------------------------------------------------------- //
+//                                Bytecode
+
+// The operations of a program. A record is an array of
+// bytes, one per atom, where nonzero is true.
+//
+//    jump_true a, L    if record[a] is true, go to L
+//    jump_false a, L   if record[a] is false, go to L
+//    ret_true          return true
+//    ret_false         return false
+//
+// A test that does not jump continues with the next
+// instruction.
+enum Opcode : std::uint8_t
+{
+  jump_true_op,
+  jump_false_op,
+  ret_true_op,
+  ret_false_op,
+};
+
+
+// An instruction. The atom and target are unused by the
+// return instructions.
+struct Instruction
+{
+  Opcode        op;
+  std::uint32_t atom;   // Id of the tested atom
+  std::uint32_t target; // Position of the next instruction, if taken
+};
+
+
+// A program evaluates a proposition over records of the
+// truth values of its atoms.
+//
+// A program is compiled to jumping code: each atom is a
+// single test, which branches to the code that is decided
+// by its value. Connectives produce no instructions, and
+// evaluation stops as soon as the value is known. Atoms
+// are identified by an atom table.
+class Program
+{
+  friend Program compile(Prop const*, Atom_table&);
+public:
+  std::size_t size() const;
+
+  Instruction const* begin() const;
+  Instruction const* end() const;
+
+  bool run(std::uint8_t const*) const;
+  void run(std::uint8_t const*, std::size_t, std::size_t, std::uint8_t*) const;
+
+private:
+  std::vector<Instruction> code_;
+};
+
+
+// The most instructions in a program.
+constexpr std::size_t program_limit = std::size_t(1) << 28;
+
+
+// Returns the number of instructions.
+inline std::size_t
+Program::size() const
+{
+  return code_.size();
+}
+
+
+inline Instruction const*
+Program::begin() const
+{
+  return code_.data();
+}
+
+
+inline Instruction const*
+Program::end() const
+{
+  return code_.data() + code_.size();
+}
+
+
+Program compile(Prop const*, Atom_table&);
+
+
+#endif